@@ -0,0 +1,265 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "cache_simulator.h"
+#include "synthetic.h"
+#include "trace_binary.h"
+#include "trace_reader.h"
+
+// CORE MICROBENCHMARKS
+//
+// `make bench && ./bench` times the simulator's hot paths with Google
+// Benchmark: the tag match, victim selection and address decoding on their
+// own, whole batches of accesses over representative geometries and access
+// patterns, and trace parsing. Every benchmark reports items per second, so
+// the "items_per_second" column is accesses (or records) per second and can be
+// compared across commits, e.g. with --benchmark_format=json.
+
+// accesses in each synthetic trace, and the bytes they cover (4 times the 64 KB caches)
+static const char *BENCH_TRACE_OPTIONS = ":accesses=1M:footprint=256K";
+static const int BENCH_BLOCK_BYTES = 64;
+
+// the BM_Simulate patterns, as generator names (see synthetic.h)
+static const char *BENCH_PATTERNS[] = {"sequential", "strided", "random", "zipfian", "pointer-chase", "matrix:n=128"};
+static const int BENCH_PATTERN_COUNT = 6;
+
+/**
+ * Struct representing a synthetic trace in the layout cacheSimulateBatch takes.
+ */
+struct SyntheticTrace
+{
+    std::vector<char> loadStore;
+    std::vector<uint64_t> addresses;
+};
+
+// a whole synthetic trace, generated once so the benchmarks time only the simulator
+static SyntheticTrace makeTrace(int pattern)
+{
+    SyntheticGenerator generator;
+    parseGenerator(std::string(BENCH_PATTERNS[pattern]) + BENCH_TRACE_OPTIONS, generator);
+    SyntheticTrace trace;
+    TraceBatch batch;
+    while (generatorNextBatch(generator, batch) > 0)
+    {
+        trace.loadStore.insert(trace.loadStore.end(), batch.loadStore.begin(), batch.loadStore.begin() + batch.count);
+        trace.addresses.insert(trace.addresses.end(), batch.addresses.begin(), batch.addresses.begin() + batch.count);
+    }
+    return trace;
+}
+
+static const SyntheticTrace &traceFor(int pattern)
+{
+    static std::vector<SyntheticTrace> traces;
+    if (traces.empty())
+    {
+        for (int p = 0; p < BENCH_PATTERN_COUNT; p++)
+        {
+            traces.push_back(makeTrace(p));
+        }
+    }
+    return traces[pattern];
+}
+
+static const char *evictionName(int policy)
+{
+    static const char *names[EVICTION_POLICY_COUNT] = {"lru", "fifo", "plru", "srrip", "brrip", "random", "lfu"};
+    return names[policy];
+}
+
+// a cache whose sets are all full, filled through the normal access path
+static void fillCache(Cache &cache, int numSets, int numBlocks, const std::string &eviction)
+{
+    cacheSetUp(cache, numSets, numBlocks, BENCH_BLOCK_BYTES, "write-allocate", "write-back", eviction);
+    for (uint64_t block = 0; block < static_cast<uint64_t>(numSets) * numBlocks; block++)
+    {
+        cacheSimulator(cache, 'l', block * BENCH_BLOCK_BYTES);
+    }
+}
+
+// findBlock over full sets of range(0) ways, half hits and half misses
+static void BM_FindBlock(benchmark::State &state)
+{
+    int numBlocks = static_cast<int>(state.range(0));
+    int numSets = 64;
+    Cache cache;
+    fillCache(cache, numSets, numBlocks, "lru");
+    std::vector<uint64_t> addresses(4096);
+    std::mt19937_64 random(7);
+    for (uint64_t &address : addresses)
+    {
+        address = (random() % (2 * static_cast<uint64_t>(numSets) * numBlocks)) * BENCH_BLOCK_BYTES;
+    }
+    for (auto _ : state)
+    {
+        for (uint64_t address : addresses)
+        {
+            benchmark::DoNotOptimize(findBlock(calculateTag(address, cache), calculateIndex(address, cache), cache));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+BENCHMARK(BM_FindBlock)->Arg(1)->Arg(4)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(256);
+
+// findReplacementBlock on full sets of range(0) ways under eviction policy range(1)
+static void BM_FindReplacementBlock(benchmark::State &state)
+{
+    int numBlocks = static_cast<int>(state.range(0));
+    int numSets = 64;
+    Cache cache;
+    fillCache(cache, numSets, numBlocks, evictionName(static_cast<int>(state.range(1))));
+    state.SetLabel(evictionName(static_cast<int>(state.range(1))));
+    int index = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(findReplacementBlock(index, cache));
+        index = (index + 1) & (numSets - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindReplacementBlock)->ArgsProduct({{4, 16, 64}, benchmark::CreateDenseRange(0, EVICTION_POLICY_COUNT - 1, 1)});
+
+static void BM_CalculateIndexTag(benchmark::State &state)
+{
+    Cache cache;
+    cacheSetUp(cache, 1024, 4, BENCH_BLOCK_BYTES, "write-allocate", "write-back", "lru");
+    const SyntheticTrace &trace = traceFor(2);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < 4096; i++)
+        {
+            benchmark::DoNotOptimize(calculateIndex(trace.addresses[i], cache));
+            benchmark::DoNotOptimize(calculateTag(trace.addresses[i], cache));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 4096);
+}
+BENCHMARK(BM_CalculateIndexTag);
+
+static void BM_DecodeAddresses(benchmark::State &state)
+{
+    Cache cache;
+    cacheSetUp(cache, 1024, 4, BENCH_BLOCK_BYTES, "write-allocate", "write-back", "lru");
+    const SyntheticTrace &trace = traceFor(2);
+    std::vector<int> indices(BATCH_DECODE_SIZE);
+    std::vector<uint64_t> tags(BATCH_DECODE_SIZE);
+    for (auto _ : state)
+    {
+        decodeAddresses(cache, trace.addresses.data(), BATCH_DECODE_SIZE, indices.data(), tags.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_DECODE_SIZE);
+}
+BENCHMARK(BM_DecodeAddresses);
+
+// end to end: a whole synthetic trace through cacheSimulateBatch on a 64 KB cache of
+// range(1) ways (direct-mapped to fully associative), access pattern range(0)
+static void BM_Simulate(benchmark::State &state)
+{
+    int pattern = static_cast<int>(state.range(0));
+    int numBlocks = static_cast<int>(state.range(1));
+    int numSets = 1024 / numBlocks;
+    const SyntheticTrace &trace = traceFor(pattern);
+    Cache cache;
+    cacheSetUp(cache, numSets, numBlocks, BENCH_BLOCK_BYTES, "write-allocate", "write-back", "lru");
+    state.SetLabel(BENCH_PATTERNS[pattern]);
+    for (auto _ : state)
+    {
+        cacheSimulateBatch(cache, trace.loadStore.data(), trace.addresses.data(), trace.addresses.size());
+    }
+    state.SetItemsProcessed(state.iterations() * trace.addresses.size());
+    state.counters["miss_rate"] = static_cast<double>(cache.loadMisses + cache.storeMisses) / (cache.loadCount + cache.storeCount);
+}
+BENCHMARK(BM_Simulate)->ArgsProduct({benchmark::CreateDenseRange(0, BENCH_PATTERN_COUNT - 1, 1), {1, 4, 16, 1024}})->Unit(benchmark::kMillisecond);
+
+// emptying a 1 MB, 16-way cache between runs: range(0) == 0 sets up a new Cache, 1 sets up
+// the same one again in its allocation, 2 resets it with cacheReset
+static void BM_CacheRecycle(benchmark::State &state)
+{
+    int mode = static_cast<int>(state.range(0));
+    Cache cache;
+    cacheSetUp(cache, 1024, 16, BENCH_BLOCK_BYTES, "write-allocate", "write-back", "lru");
+    for (auto _ : state)
+    {
+        if (mode == 0)
+        {
+            Cache fresh;
+            cacheSetUp(fresh, 1024, 16, BENCH_BLOCK_BYTES, "write-allocate", "write-back", "lru");
+            benchmark::DoNotOptimize(fresh.storage.get());
+        }
+        else if (mode == 1)
+        {
+            cacheSetUp(cache, 1024, 16, BENCH_BLOCK_BYTES, "write-allocate", "write-back", "lru");
+        }
+        else
+        {
+            cacheReset(cache);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(mode == 0 ? "new" : mode == 1 ? "set up again" : "reset");
+}
+BENCHMARK(BM_CacheRecycle)->DenseRange(0, 2);
+
+// writes the random trace to a temporary file, as text or in the delta binary format
+static std::string writeTraceFile(bool binary)
+{
+    char path[] = "/tmp/csim-bench-XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    const SyntheticTrace &trace = traceFor(2);
+    if (binary)
+    {
+        TraceWriter writer;
+        traceWriterOpen(writer, path, TRACE_FLAG_DELTA);
+        for (size_t i = 0; i < trace.addresses.size(); i++)
+        {
+            traceWrite(writer, TraceRecord{trace.loadStore[i], trace.addresses[i], 4, 0});
+        }
+        traceWriterClose(writer);
+    }
+    else
+    {
+        std::FILE *file = std::fopen(path, "w");
+        for (size_t i = 0; i < trace.addresses.size(); i++)
+        {
+            std::fprintf(file, "%c 0x%llx 4\n", trace.loadStore[i], static_cast<unsigned long long>(trace.addresses[i]));
+        }
+        std::fclose(file);
+    }
+    return path;
+}
+
+// parse throughput of a mapped trace file, text for range(0) == 0, delta binary otherwise
+static void BM_TraceParse(benchmark::State &state)
+{
+    bool binary = state.range(0) != 0;
+    std::string path = writeTraceFile(binary);
+    state.SetLabel(binary ? "binary" : "text");
+    TraceBatch batch;
+    size_t records = 0;
+    for (auto _ : state)
+    {
+        TraceReader reader;
+        if (traceOpen(reader, path.c_str()) == 1)
+        {
+            state.SkipWithError("could not open the trace");
+            break;
+        }
+        while (traceNextBatch(reader, batch) > 0)
+        {
+            records += batch.count;
+        }
+        traceClose(reader);
+    }
+    std::remove(path.c_str());
+    state.SetItemsProcessed(records);
+}
+BENCHMARK(BM_TraceParse)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -1,8 +1,18 @@
 #include <iostream>
 #include <string>
-#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <vector>
 
 #include "cache_simulator.h"
+#include "hierarchy.h"
+#include "prefetch.h"
+#include "miss_classifier.h"
+#include "hotspot.h"
+#include "partition.h"
+#include "victim_cache.h"
 
 void displayStatistics(Cache &cache)
 {
@@ -31,6 +41,21 @@ bool checkPowTwo(int x)
     return false;
 }
 
+bool parseEvictionPolicy(const std::string &name, EvictionPolicy &policy)
+{
+    // in enum order
+    static const char *const names[EVICTION_POLICY_COUNT] = {"lru", "fifo", "plru", "srrip", "brrip", "random", "lfu"};
+    for (int i = 0; i < EVICTION_POLICY_COUNT; i++)
+    {
+        if (name == names[i])
+        {
+            policy = static_cast<EvictionPolicy>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
 // return 0 for success, 1 for bad input
 int validateArguments(int numSets, int numBlocks, int blockSize, std::string handleMiss, std::string handleWrite, std::string handleEviction)
 {
@@ -80,250 +105,1283 @@ int validateArguments(int numSets, int numBlocks, int blockSize, std::string han
         return 1;
     }
 
-    if (handleEviction != "lru" && handleEviction != "fifo")
+    EvictionPolicy eviction;
+    if (!parseEvictionPolicy(handleEviction, eviction))
     {
-        std::cerr << "Invalid input, not lru or fifo. Exiting.\n";
+        std::cerr << "Invalid input, not lru, fifo, plru, srrip, brrip, random or lfu. Exiting.\n";
         return 1;
     }
 
     return 0;
 }
 
-int calculateIndex(int address, Cache &cache)
+int log2PowTwo(int x)
 {
-    int offset = log2(cache.numBytes);
-    int index = log2(cache.numSets);
-    int shifted = address >> offset;
-    int mask = (1 << index) - 1;
+    int bits = 0;
+    while ((1 << bits) < x)
+    {
+        bits++;
+    }
+    return bits;
+}
 
-    return (shifted & mask);
+int calculateIndex(uint64_t address, Cache &cache)
+{
+    return static_cast<int>(address >> cache.offsetBits) & cache.indexMask;
 }
 
-int calculateTag(int address, Cache &cache)
+uint64_t calculateTag(uint64_t address, Cache &cache)
 {
-    int offset = log2(cache.numBytes);
-    int index = log2(cache.numSets);
-    return (address >> (offset + index));
+    return address >> (cache.offsetBits + cache.indexBits);
 }
 
-void cacheSetUp(Cache &cache, int numSets, int numBlocks, int numBytes, std::string handleMiss, std::string handleWrite, std::string handleEviction)
+void decodeAddresses(const Cache &cache, const uint64_t *__restrict addresses, size_t count, int *__restrict indices, uint64_t *__restrict tags)
+{
+    const int offsetBits = cache.offsetBits;
+    const int tagShift = cache.offsetBits + cache.indexBits;
+    const int indexMask = cache.indexMask;
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++)
+    {
+        // same arithmetic as calculateIndex / calculateTag
+        uint64_t address = addresses[i];
+        indices[i] = static_cast<int>(address >> offsetBits) & indexMask;
+        tags[i] = address >> tagShift;
+    }
+}
+
+// xorshift seed of random replacement and BRRIP: any nonzero value, fixed so runs are repeatable
+static const uint64_t CACHE_RANDOM_SEED = 0x9e3779b97f4a7c15ULL;
+
+void AlignedFree::operator()(void *p) const
+{
+    std::free(p);
+}
+
+// rounds a byte count up to a whole number of host cache lines
+static size_t lineAlign(size_t bytes)
+{
+    return (bytes + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES * CACHE_LINE_BYTES;
+}
+
+// byte sizes of the arrays of one layout, each a whole number of host cache lines
+struct StorageLayout
+{
+    size_t tagBytes;
+    size_t tsBytes;
+    size_t maskBytes;
+    size_t plruBytes;
+    size_t rrpvBytes;
+    size_t linkBytes;
+    size_t endBytes;
+    size_t total;
+};
+
+static StorageLayout storageLayout(int numSets, int wayStride, int maskWords, bool orderList, EvictionPolicy evictionPolicy, bool wide)
+{
+    size_t ways = static_cast<size_t>(numSets) * wayStride;
+    size_t masks = static_cast<size_t>(numSets) * maskWords;
+    bool rrip = evictionPolicy == EvictionPolicy::SRRIP || evictionPolicy == EvictionPolicy::BRRIP;
+
+    StorageLayout layout;
+    layout.tagBytes = lineAlign(ways * (wide ? sizeof(uint64_t) : sizeof(uint32_t)));
+    layout.tsBytes = lineAlign(ways * sizeof(uint32_t));
+    layout.maskBytes = lineAlign(masks * sizeof(uint64_t));
+    layout.plruBytes = evictionPolicy == EvictionPolicy::PLRU ? layout.maskBytes : 0;
+    layout.rrpvBytes = rrip ? lineAlign(ways) : 0;
+    layout.linkBytes = orderList ? lineAlign(ways * sizeof(int)) : 0;
+    layout.endBytes = orderList ? lineAlign(static_cast<size_t>(numSets) * sizeof(int)) : 0;
+    layout.total = layout.tagBytes + 2 * layout.tsBytes + 2 * layout.maskBytes + layout.plruBytes + layout.rrpvBytes +
+                   2 * layout.linkBytes + 2 * layout.endBytes;
+    return layout;
+}
+
+// makes the cache's allocation at least total bytes, keeping one that is large enough; throws
+// std::bad_alloc before changing anything if a new one cannot be had
+static void reserveStorage(Cache &cache, size_t total)
+{
+    if (cache.storage && cache.storageCapacity >= total)
+    {
+        return;
+    }
+    uint8_t *base = static_cast<uint8_t *>(std::aligned_alloc(CACHE_LINE_BYTES, total));
+    if (base == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    cache.storage.reset(base);
+    cache.storageCapacity = total;
+}
+
+// lays out every per-way and per-set array in one zeroed allocation, 32- or 64-bit tags first
+static void allocateStorage(Cache &cache, bool wide)
+{
+    StorageLayout layout = storageLayout(cache.numSets, cache.wayStride, cache.maskWords, cache.orderList, cache.evictionPolicy, wide);
+    size_t tagBytes = layout.tagBytes;
+    size_t tsBytes = layout.tsBytes;
+    size_t maskBytes = layout.maskBytes;
+    size_t plruBytes = layout.plruBytes;
+    size_t rrpvBytes = layout.rrpvBytes;
+    size_t linkBytes = layout.linkBytes;
+    size_t endBytes = layout.endBytes;
+
+    reserveStorage(cache, layout.total);
+    uint8_t *base = cache.storage.get();
+    // initialize blocks with default values (all zero: invalid, clean, never accessed)
+    std::memset(base, 0, layout.total);
+    cache.storageBytes = layout.total;
+    cache.tags = wide ? nullptr : reinterpret_cast<uint32_t *>(base);
+    cache.wideTags = wide ? reinterpret_cast<uint64_t *>(base) : nullptr;
+    cache.loadTs = reinterpret_cast<uint32_t *>(base + tagBytes);
+    cache.accessTs = reinterpret_cast<uint32_t *>(base + tagBytes + tsBytes);
+    cache.valid = reinterpret_cast<uint64_t *>(base + tagBytes + 2 * tsBytes);
+    cache.dirty = reinterpret_cast<uint64_t *>(base + tagBytes + 2 * tsBytes + maskBytes);
+    uint8_t *policy = base + tagBytes + 2 * tsBytes + 2 * maskBytes;
+    cache.plruBits = plruBytes ? reinterpret_cast<uint64_t *>(policy) : nullptr;
+    cache.rrpv = rrpvBytes ? policy + plruBytes : nullptr;
+    if (cache.orderList)
+    {
+        uint8_t *links = policy + plruBytes + rrpvBytes;
+        cache.orderPrev = reinterpret_cast<int *>(links);
+        cache.orderNext = reinterpret_cast<int *>(links + linkBytes);
+        cache.orderHead = reinterpret_cast<int *>(links + 2 * linkBytes);
+        cache.orderTail = reinterpret_cast<int *>(links + 2 * linkBytes + endBytes);
+    }
+    else
+    {
+        cache.orderPrev = cache.orderNext = cache.orderHead = cache.orderTail = nullptr;
+    }
+}
+
+void cacheWidenTags(Cache &cache)
+{
+    if (cache.tags == nullptr)
+    {
+        return;
+    }
+    // the narrow arrays stay in place until the wide ones exist, so a failed allocation changes nothing
+    StorageLayout layout = storageLayout(cache.numSets, cache.wayStride, cache.maskWords, cache.orderList, cache.evictionPolicy, true);
+    std::unique_ptr<uint8_t, AlignedFree> old = std::move(cache.storage);
+    size_t oldCapacity = cache.storageCapacity;
+    try
+    {
+        reserveStorage(cache, layout.total);
+    }
+    catch (const std::bad_alloc &)
+    {
+        cache.storage = std::move(old);
+        cache.storageCapacity = oldCapacity;
+        throw;
+    }
+    const uint32_t *tags = cache.tags;
+    const uint32_t *loadTs = cache.loadTs;
+    const uint32_t *accessTs = cache.accessTs;
+    const uint64_t *valid = cache.valid;
+    const uint64_t *dirty = cache.dirty;
+    const uint64_t *plruBits = cache.plruBits;
+    const uint8_t *rrpv = cache.rrpv;
+    const int *orderPrev = cache.orderPrev;
+    const int *orderNext = cache.orderNext;
+    const int *orderHead = cache.orderHead;
+    const int *orderTail = cache.orderTail;
+
+    allocateStorage(cache, true);
+    size_t ways = static_cast<size_t>(cache.numSets) * cache.wayStride;
+    size_t masks = static_cast<size_t>(cache.numSets) * cache.maskWords;
+    for (size_t i = 0; i < ways; i++)
+    {
+        cache.wideTags[i] = tags[i];
+    }
+    std::memcpy(cache.loadTs, loadTs, ways * sizeof(uint32_t));
+    std::memcpy(cache.accessTs, accessTs, ways * sizeof(uint32_t));
+    std::memcpy(cache.valid, valid, masks * sizeof(uint64_t));
+    std::memcpy(cache.dirty, dirty, masks * sizeof(uint64_t));
+    if (cache.plruBits)
+    {
+        std::memcpy(cache.plruBits, plruBits, masks * sizeof(uint64_t));
+    }
+    if (cache.rrpv)
+    {
+        std::memcpy(cache.rrpv, rrpv, ways);
+    }
+    if (cache.orderList)
+    {
+        std::memcpy(cache.orderPrev, orderPrev, ways * sizeof(int));
+        std::memcpy(cache.orderNext, orderNext, ways * sizeof(int));
+        std::memcpy(cache.orderHead, orderHead, cache.numSets * sizeof(int));
+        std::memcpy(cache.orderTail, orderTail, cache.numSets * sizeof(int));
+    }
+}
+
+// replaces one array of stamps with their rank within each set
+static void renumberArray(Cache &cache, uint32_t *stamps)
 {
-    // initialize blocks with default values
-    for (int i = 0; i < numSets; i++)
+    std::vector<int> ways(cache.numBlocks);
+    for (int index = 0; index < cache.numSets; index++)
     {
-        Set set;
-        for (int j = 0; j < numBlocks; j++)
+        uint32_t *set = stamps + cache.slot(index, 0);
+        for (int way = 0; way < cache.numBlocks; way++)
         {
-            Slot slot;
-            slot.tag = 0;
-            slot.valid = false;
-            slot.dirty = false;
-            slot.load_ts = 0;
-            slot.access_ts = 0;
-            set.slots.push_back(slot);
+            ways[way] = way;
         }
-        cache.sets.push_back(set);
+        // stable, so equal stamps keep their lowest-way-first order
+        std::stable_sort(ways.begin(), ways.end(), [&](int a, int b)
+                         { return set[a] < set[b]; });
+        for (int rank = 0; rank < cache.numBlocks; rank++)
+        {
+            set[ways[rank]] = rank + 1;
+        }
+    }
+}
+
+// keeps stamps ordered across a wrap of the 32-bit access clock: only their order within
+// a set matters, so every set is renumbered from 1 and the clock restarts above them
+static void renumberStamps(Cache &cache)
+{
+    renumberArray(cache, cache.loadTs);
+    if (cache.evictionPolicy != EvictionPolicy::LFU) // LFU keeps access counts there
+    {
+        renumberArray(cache, cache.accessTs);
+    }
+    cache.accessClock = cache.numBlocks;
+}
+
+// next replacement stamp, greater than every stamp already in the cache
+static inline uint32_t nextStamp(Cache &cache)
+{
+    if (__builtin_expect(cache.accessClock == UINT32_MAX, 0))
+    {
+        renumberStamps(cache);
+    }
+    return ++cache.accessClock;
+}
+
+void cacheSetUp(Cache &cache, int numSets, int numBlocks, int numBytes, std::string handleMiss, std::string handleWrite, std::string handleEviction)
+{
+    // resolve the policy strings once so the per-access path never compares them
+    MissPolicy missPolicy = (handleMiss == "no-write-allocate") ? MissPolicy::NoWriteAllocate : MissPolicy::WriteAllocate;
+    WritePolicy writePolicy = (handleWrite == "write-back") ? WritePolicy::WriteBack : WritePolicy::WriteThrough;
+    EvictionPolicy evictionPolicy;
+    if (!parseEvictionPolicy(handleEviction, evictionPolicy))
+    {
+        evictionPolicy = EvictionPolicy::LRU;
     }
 
+    // lay out every array in one allocation, each set's tags on their own host cache lines;
+    // the stride is a whole line of 32-bit tags, so it stays valid if the tags widen
+    const int tagsPerLine = CACHE_LINE_BYTES / sizeof(uint32_t);
+    int wayStride = (numBlocks + tagsPerLine - 1) / tagsPerLine * tagsPerLine;
+    int maskWords = (numBlocks + 63) / 64;
+    bool orderList = numBlocks > ORDER_LIST_MIN_WAYS &&
+                     (evictionPolicy == EvictionPolicy::LRU || evictionPolicy == EvictionPolicy::FIFO);
+    // the allocation comes before any field changes: if it fails, the cache is left as it was
+    reserveStorage(cache, storageLayout(numSets, wayStride, maskWords, orderList, evictionPolicy, false).total);
+
     // set up cache size
     cache.numSets = numSets;
     cache.numBlocks = numBlocks;
     cache.numBytes = numBytes;
+    cache.offsetBits = log2PowTwo(numBytes);
+    cache.indexBits = log2PowTwo(numSets);
+    cache.indexMask = numSets - 1;
+    cache.wayBits = log2PowTwo(numBlocks);
+
+    // set up cache policies (swapped in, which cannot throw)
+    cache.handleMiss.swap(handleMiss);
+    cache.handleWrite.swap(handleWrite);
+    cache.handleEviction.swap(handleEviction);
+    cache.missPolicy = missPolicy;
+    cache.writePolicy = writePolicy;
+    cache.evictionPolicy = evictionPolicy;
+    cache.simulate = selectAccessFunction(cache.missPolicy, cache.writePolicy, cache.evictionPolicy);
+    cache.simulateBatch = selectBatchFunction(cache.missPolicy, cache.writePolicy, cache.evictionPolicy);
+    cache.tagMatch = selectTagMatch(numBlocks);
+    cache.wideTagMatch = selectWideTagMatch(numBlocks);
+    cache.randomState = CACHE_RANDOM_SEED;
+
+    // a cache set up again runs the plain access path, without what was attached before
+    cache.prefetcher = nullptr;
+    cache.missClassifier = nullptr;
+    cache.hotSpots = nullptr;
+    cache.partition = nullptr;
+    cache.victimCache = nullptr;
+
+    cache.wayStride = wayStride;
+    cache.maskWords = maskWords;
+    cache.orderList = orderList;
+    cache.accessClock = 0;
+    allocateStorage(cache, false);
+    if (cache.orderList)
+    {
+
+        // every set starts as the list 0 -> 1 -> ... -> numBlocks - 1; invalid ways are
+        // always filled before the tail is consulted, so the initial order never matters
+        for (int index = 0; index < numSets; index++)
+        {
+            for (int way = 0; way < numBlocks; way++)
+            {
+                cache.orderPrev[cache.slot(index, way)] = way - 1;
+                cache.orderNext[cache.slot(index, way)] = (way + 1 < numBlocks) ? way + 1 : -1;
+            }
+            cache.orderHead[index] = 0;
+            cache.orderTail[index] = numBlocks - 1;
+        }
+    }
+}
+
+void cacheClearStatistics(Cache &cache)
+{
+    timingDrain(cache);
+    timingSetUp(cache, cache.timing);
+    cache.loadCount = 0;
+    cache.storeCount = 0;
+    cache.loadHits = 0;
+    cache.loadMisses = 0;
+    cache.storeHits = 0;
+    cache.storeMisses = 0;
+    cache.totalCycles = 0;
+    cache.writeBacks = 0;
+    cache.backInvalidations = 0;
+    cache.bufferedWrites = 0;
+    cache.coalescedWrites = 0;
+    cache.writeStalls = 0;
+    cache.writeStallCycles = 0;
+    if (cache.prefetcher)
+    {
+        prefetcherClearStatistics(*cache.prefetcher);
+    }
+    if (cache.missClassifier)
+    {
+        missClassifierClearStatistics(*cache.missClassifier);
+    }
+    if (cache.hotSpots)
+    {
+        hotSpotClearStatistics(*cache.hotSpots);
+    }
+    if (cache.victimCache)
+    {
+        victimCacheClearStatistics(*cache.victimCache);
+    }
+}
+
+void cacheReset(Cache &cache)
+{
+    // every block invalid and clean; tags, stamps, RRIP predictions and order lists are
+    // rewritten by the fills before an eviction reads them, so they are kept as they are
+    size_t masks = static_cast<size_t>(cache.numSets) * cache.maskWords;
+    std::memset(cache.valid, 0, masks * sizeof(uint64_t));
+    std::memset(cache.dirty, 0, masks * sizeof(uint64_t));
+    if (cache.plruBits)
+    {
+        std::memset(cache.plruBits, 0, masks * sizeof(uint64_t));
+    }
+    cache.accessClock = 0;
+    cache.randomState = CACHE_RANDOM_SEED;
+    if (cache.victimCache)
+    {
+        victimCacheAttach(*cache.victimCache, cache);
+    }
+    if (cache.partition)
+    {
+        partitionAttach(*cache.partition, cache);
+    }
+    cacheClearStatistics(cache);
+}
+
+// POLICY-SPECIALIZED CORE
+//
+// Each function below is instantiated for one policy combination, so every
+// policy test is resolved at compile time. The public functions further down
+// dispatch to the matching instantiation from the enums set in cacheSetUp.
+
+template <WritePolicy Write>
+static int evictBlock(int index, int victim, Cache &cache)
+{
+    if (cache.nextLevel || cache.prevLevel)
+    {
+        evictToNextLevel(cache, index, victim);
+        return victim;
+    }
+    if (__builtin_expect(cache.victimCache != nullptr, 0))
+    {
+        // the block moves to the victim cache, which writes it back later if it is dirty
+        victimCacheInsert(*cache.victimCache, cache, blockAddress(cache, index, cache.tagAt(cache.slot(index, victim))),
+                          cache.isDirty(index, victim));
+        cache.setDirty(index, victim, false);
+        return victim;
+    }
+    if (Write == WritePolicy::WriteBack && cache.isDirty(index, victim))
+    {
+        uint64_t address = blockAddress(cache, index, cache.tagAt(cache.slot(index, victim)));
+        cache.setValid(index, victim, false);
+        cache.setDirty(index, victim, false);
+        cache.writeBacks++;
+        chargeWrite(cache, memoryCycles(cache.timing, cache.numBytes), address); // store to memory
+    }
+    return victim;
+}
+
+// moves a way to the head of its set's replacement order list
+static void orderTouch(Cache &cache, int index, int way)
+{
+    int head = cache.orderHead[index];
+    if (head == way)
+    {
+        return;
+    }
+    size_t base = cache.slot(index, 0);
+    int prev = cache.orderPrev[base + way];
+    int next = cache.orderNext[base + way];
+
+    // unlink (way is not the head, so prev is a real way)
+    cache.orderNext[base + prev] = next;
+    if (next >= 0)
+    {
+        cache.orderPrev[base + next] = prev;
+    }
+    else
+    {
+        cache.orderTail[index] = prev;
+    }
+
+    // push in front of the old head
+    cache.orderPrev[base + way] = -1;
+    cache.orderNext[base + way] = head;
+    cache.orderPrev[base + head] = way;
+    cache.orderHead[index] = way;
+}
+
+// way holding the smallest timestamp, the lowest way on ties
+static int oldestWay(const uint32_t *timestamps, int numBlocks)
+{
+    int temp = 0;
+    for (int way = 1; way < numBlocks; way++)
+    {
+        // find min
+        if (timestamps[way] < timestamps[temp])
+        {
+            temp = way;
+        }
+    }
+    return temp;
+}
+
+template <WritePolicy Write>
+static int lruBlock(int index, Cache &cache)
+{
+    int victim = cache.orderList ? cache.orderTail[index] : oldestWay(cache.accessTs + cache.slot(index, 0), cache.numBlocks);
+    return evictBlock<Write>(index, victim, cache);
+}
+
+template <WritePolicy Write>
+static int fifoBlock(int index, Cache &cache)
+{
+    int victim = cache.orderList ? cache.orderTail[index] : oldestWay(cache.loadTs + cache.slot(index, 0), cache.numBlocks);
+    return evictBlock<Write>(index, victim, cache);
+}
+
+// xorshift64*, for random replacement and BRRIP's occasional near insertion
+static inline uint64_t nextRandom(Cache &cache)
+{
+    uint64_t x = cache.randomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    cache.randomState = x;
+    return x * 0x2545f4914f6cdd1dULL;
+}
+
+// points every PLRU tree node on the path to a way at the other half
+static void plruTouch(Cache &cache, int index, int way)
+{
+    uint64_t *bits = cache.plruBits + static_cast<size_t>(index) * cache.maskWords;
+    int node = 1;
+    for (int level = cache.wayBits - 1; level >= 0; level--)
+    {
+        int upper = (way >> level) & 1;
+        if (upper)
+        {
+            bits[node >> 6] &= ~(1ULL << (node & 63));
+        }
+        else
+        {
+            bits[node >> 6] |= 1ULL << (node & 63);
+        }
+        node = 2 * node + upper;
+    }
+}
 
-    // set up cache policies
-    cache.handleMiss = handleMiss;
-    cache.handleWrite = handleWrite;
-    cache.handleEviction = handleEviction;
+// follows the PLRU tree from the root to the way it points at
+static int plruVictim(const Cache &cache, int index)
+{
+    const uint64_t *bits = cache.plruBits + static_cast<size_t>(index) * cache.maskWords;
+    int node = 1;
+    for (int level = 0; level < cache.wayBits; level++)
+    {
+        node = 2 * node + static_cast<int>((bits[node >> 6] >> (node & 63)) & 1);
+    }
+    return node - cache.numBlocks;
+}
+
+// first way with a distant prediction, after ageing the set until one exists
+static int rripVictim(Cache &cache, int index)
+{
+    uint8_t *rrpv = cache.rrpv + cache.slot(index, 0);
+    uint8_t oldest = 0;
+    for (int way = 0; way < cache.numBlocks; way++)
+    {
+        oldest = std::max(oldest, rrpv[way]);
+    }
+    uint8_t age = RRIP_MAX - oldest;
+    int victim = -1;
+    for (int way = 0; way < cache.numBlocks; way++)
+    {
+        rrpv[way] += age;
+        if (victim < 0 && rrpv[way] == RRIP_MAX)
+        {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+// way with the fewest accesses, the earliest filled among those
+static int lfuVictim(const Cache &cache, int index)
+{
+    const uint32_t *count = cache.accessTs + cache.slot(index, 0);
+    const uint32_t *filled = cache.loadTs + cache.slot(index, 0);
+    int victim = 0;
+    for (int way = 1; way < cache.numBlocks; way++)
+    {
+        if (count[way] < count[victim] || (count[way] == count[victim] && filled[way] < filled[victim]))
+        {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+// way with the smallest timestamp among the allowed ways, the lowest on ties
+static int oldestAllowedWay(const uint32_t *timestamps, uint64_t allowed)
+{
+    int temp = __builtin_ctzll(allowed);
+    for (uint64_t rest = allowed & (allowed - 1); rest != 0; rest &= rest - 1)
+    {
+        int way = __builtin_ctzll(rest);
+        if (timestamps[way] < timestamps[temp])
+        {
+            temp = way;
+        }
+    }
+    return temp;
 }
 
-void handleLoad(Cache &cache, int index, int tag, Slot *hit)
+// the PLRU tree walk, turning away from any half without an allowed way
+static int plruAllowedVictim(const Cache &cache, int index, uint64_t allowed)
+{
+    const uint64_t *bits = cache.plruBits + static_cast<size_t>(index) * cache.maskWords;
+    int node = 1;
+    int first = 0;
+    for (int half = cache.numBlocks / 2; half > 0; half /= 2)
+    {
+        int upper = static_cast<int>((bits[node >> 6] >> (node & 63)) & 1);
+        uint64_t chosen = ((uint64_t(1) << half) - 1) << (first + upper * half);
+        if ((allowed & chosen) == 0)
+        {
+            upper = !upper;
+        }
+        first += upper * half;
+        node = 2 * node + upper;
+    }
+    return first;
+}
+
+// the RRIP victim among the allowed ways, ageing only them
+static int rripAllowedVictim(Cache &cache, int index, uint64_t allowed)
+{
+    uint8_t *rrpv = cache.rrpv + cache.slot(index, 0);
+    uint8_t oldest = 0;
+    for (uint64_t rest = allowed; rest != 0; rest &= rest - 1)
+    {
+        oldest = std::max(oldest, rrpv[__builtin_ctzll(rest)]);
+    }
+    uint8_t age = RRIP_MAX - oldest;
+    int victim = -1;
+    for (uint64_t rest = allowed; rest != 0; rest &= rest - 1)
+    {
+        int way = __builtin_ctzll(rest);
+        rrpv[way] += age;
+        if (victim < 0 && rrpv[way] == RRIP_MAX)
+        {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+// the LFU victim among the allowed ways
+static int lfuAllowedVictim(const Cache &cache, int index, uint64_t allowed)
+{
+    const uint32_t *count = cache.accessTs + cache.slot(index, 0);
+    const uint32_t *filled = cache.loadTs + cache.slot(index, 0);
+    int victim = __builtin_ctzll(allowed);
+    for (uint64_t rest = allowed & (allowed - 1); rest != 0; rest &= rest - 1)
+    {
+        int way = __builtin_ctzll(rest);
+        if (count[way] < count[victim] || (count[way] == count[victim] && filled[way] < filled[victim]))
+        {
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+// replacement restricted to the ways of the current class's mask (caches of at most
+// 64 ways, so the set's valid bits are one word)
+template <WritePolicy Write, EvictionPolicy Eviction>
+static int partitionedBlock(int index, Cache &cache)
+{
+    WayPartition &partition = *cache.partition;
+    uint64_t allowed = partition.masks[partition.current];
+    uint64_t invalid = ~cache.valid[index] & allowed;
+    int victim;
+    if (invalid != 0)
+    {
+        victim = __builtin_ctzll(invalid);
+    }
+    else
+    {
+        if (Eviction == EvictionPolicy::LRU || Eviction == EvictionPolicy::FIFO)
+        {
+            if (cache.orderList)
+            {
+                // the oldest way of the order list that is allowed
+                size_t base = cache.slot(index, 0);
+                victim = cache.orderTail[index];
+                while (!((allowed >> victim) & 1))
+                {
+                    victim = cache.orderPrev[base + victim];
+                }
+            }
+            else
+            {
+                const uint32_t *stamps = Eviction == EvictionPolicy::LRU ? cache.accessTs : cache.loadTs;
+                victim = oldestAllowedWay(stamps + cache.slot(index, 0), allowed);
+            }
+        }
+        else if (Eviction == EvictionPolicy::PLRU)
+        {
+            victim = plruAllowedVictim(cache, index, allowed);
+        }
+        else if (Eviction == EvictionPolicy::SRRIP || Eviction == EvictionPolicy::BRRIP)
+        {
+            victim = rripAllowedVictim(cache, index, allowed);
+        }
+        else if (Eviction == EvictionPolicy::Random)
+        {
+            // the n-th allowed way
+            uint64_t rest = allowed;
+            for (int n = static_cast<int>(nextRandom(cache) % __builtin_popcountll(allowed)); n > 0; n--)
+            {
+                rest &= rest - 1;
+            }
+            victim = __builtin_ctzll(rest);
+        }
+        else // lfu
+        {
+            victim = lfuAllowedVictim(cache, index, allowed);
+        }
+        partition.occupancy[partition.owner[cache.slot(index, victim)]]--;
+        evictBlock<Write>(index, victim, cache);
+    }
+    partition.owner[cache.slot(index, victim)] = static_cast<uint8_t>(partition.current);
+    partition.occupancy[partition.current]++;
+    return victim;
+}
+
+template <WritePolicy Write, EvictionPolicy Eviction>
+static int replacementBlock(int index, Cache &cache)
+{
+    if (__builtin_expect(cache.partition != nullptr, 0))
+    {
+        return partitionedBlock<Write, Eviction>(index, cache);
+    }
+    // can fill in invalid slot: first clear bit of the valid mask
+    const uint64_t *valid = cache.valid + static_cast<size_t>(index) * cache.maskWords;
+    for (int word = 0; word < cache.maskWords; word++)
+    {
+        uint64_t invalid = ~valid[word];
+        if (invalid != 0)
+        {
+            int way = word * 64 + __builtin_ctzll(invalid);
+            if (way < cache.numBlocks)
+            {
+                return way;
+            }
+        }
+    }
+    // no invalids, needs to evict
+    if (Eviction == EvictionPolicy::LRU)
+    {
+        return lruBlock<Write>(index, cache);
+    }
+    if (Eviction == EvictionPolicy::FIFO)
+    {
+        return fifoBlock<Write>(index, cache);
+    }
+    int victim;
+    if (Eviction == EvictionPolicy::PLRU)
+    {
+        victim = plruVictim(cache, index);
+    }
+    else if (Eviction == EvictionPolicy::SRRIP || Eviction == EvictionPolicy::BRRIP)
+    {
+        victim = rripVictim(cache, index);
+    }
+    else if (Eviction == EvictionPolicy::Random)
+    {
+        victim = static_cast<int>(nextRandom(cache) & (cache.numBlocks - 1));
+    }
+    else // lfu
+    {
+        victim = lfuVictim(cache, index);
+    }
+    return evictBlock<Write>(index, victim, cache);
+}
+
+// updates the replacement state of a way that was just hit
+template <EvictionPolicy Eviction>
+static inline void touchBlock(Cache &cache, int index, int way)
+{
+    size_t slot = cache.slot(index, way);
+    if (Eviction == EvictionPolicy::LRU)
+    {
+        cache.accessTs[slot] = nextStamp(cache);
+        if (cache.orderList)
+        {
+            orderTouch(cache, index, way);
+        }
+    }
+    else if (Eviction == EvictionPolicy::PLRU)
+    {
+        plruTouch(cache, index, way);
+    }
+    else if (Eviction == EvictionPolicy::SRRIP || Eviction == EvictionPolicy::BRRIP)
+    {
+        cache.rrpv[slot] = 0; // predicted to be re-referenced soon
+    }
+    else if (Eviction == EvictionPolicy::LFU)
+    {
+        if (cache.accessTs[slot] != UINT32_MAX)
+        {
+            cache.accessTs[slot]++;
+        }
+    }
+    // fifo and random ignore hits
+}
+
+// sets the replacement state of a way that was just filled
+template <EvictionPolicy Eviction>
+static inline void stampFill(Cache &cache, int index, int way)
+{
+    size_t slot = cache.slot(index, way);
+    if (Eviction == EvictionPolicy::LRU)
+    {
+        cache.accessTs[slot] = nextStamp(cache);
+    }
+    else if (Eviction == EvictionPolicy::FIFO)
+    {
+        cache.loadTs[slot] = nextStamp(cache);
+    }
+    else if (Eviction == EvictionPolicy::PLRU)
+    {
+        plruTouch(cache, index, way);
+    }
+    else if (Eviction == EvictionPolicy::SRRIP)
+    {
+        cache.rrpv[slot] = RRIP_MAX - 1; // a long re-reference interval
+    }
+    else if (Eviction == EvictionPolicy::BRRIP)
+    {
+        // mostly distant, so a scan cannot flush the set
+        cache.rrpv[slot] = (nextRandom(cache) % BRRIP_LONG_CHANCE == 0) ? RRIP_MAX - 1 : RRIP_MAX;
+    }
+    else if (Eviction == EvictionPolicy::LFU)
+    {
+        cache.accessTs[slot] = 1;
+        cache.loadTs[slot] = nextStamp(cache);
+    }
+    if (cache.orderList)
+    {
+        orderTouch(cache, index, way); // newest access (LRU) or newest fill (FIFO)
+    }
+}
+
+// places a block in a way chosen by replacementBlock, stamping it for the eviction policy
+template <EvictionPolicy Eviction>
+static void placeBlock(int index, int way, uint64_t tag, Cache &cache)
+{
+    size_t slot = cache.slot(index, way);
+    cache.totalCycles += cache.timing.fillLatency; // time for updating cache
+    cache.setValid(index, way, true);
+    if (cache.tags && (tag >> 32) != 0)
+    {
+        cacheWidenTags(cache);
+    }
+    if (cache.tags)
+    {
+        cache.tags[slot] = static_cast<uint32_t>(tag);
+    }
+    else
+    {
+        cache.wideTags[slot] = tag;
+    }
+    stampFill<Eviction>(cache, index, way);
+}
+
+// brings a missing block into the cache
+template <WritePolicy Write, EvictionPolicy Eviction>
+static int fillBlock(int index, uint64_t tag, Cache &cache)
+{
+    int way = replacementBlock<Write, Eviction>(index, cache);
+    placeBlock<Eviction>(index, way, tag, cache);
+    return way;
+}
+
+template <WritePolicy Write, EvictionPolicy Eviction>
+static void loadAccess(Cache &cache, int index, uint64_t tag, int hit)
 {
     cache.loadCount++;
     // load hit
-    if (hit)
+    if (hit >= 0)
     {
         cache.loadHits++;
-        cache.totalCycles++;
-        if (cache.handleEviction == "lru")
+        if (cache.timing.mshrs)
         {
-            hit->access_ts = cache.totalCycles; // uses cycles as a timestamp
+            waitForFill(cache, blockAddress(cache, index, tag));
         }
+        cache.totalCycles += cache.timing.hitLatency;
+        touchBlock<Eviction>(cache, index, hit);
     }
     // load miss
     else
     {
         cache.loadMisses++;
-        cache.totalCycles += 100 * cache.numBytes / 4; // pretend we access from memory here
-        // if it's a miss, bring the info from the memory into the cache
-        Slot *temp = findReplacementBlock(index, cache);
-        cache.totalCycles++; // time for updating cache
-        temp->valid = true;
-        temp->tag = tag;
-        if (cache.handleEviction == "lru")
+        bool dirty = false;
+        if (cache.nextLevel)
+        {
+            dirty = fetchFromNextLevel(cache, index, tag);
+        }
+        else if (cache.victimCache && victimCacheTake(*cache.victimCache, cache, blockAddress(cache, index, tag), dirty))
         {
-            temp->access_ts = cache.totalCycles;
-        } 
-        else //fifo 
+            // swapped back from the victim cache
+        }
+        else
         {
-            temp->load_ts = cache.totalCycles;
+            // pretend we access from memory here
+            chargeFill(cache, memoryCycles(cache.timing, cache.numBytes), blockAddress(cache, index, tag));
+        }
+        // if it's a miss, bring the info from the memory into the cache
+        int way = fillBlock<Write, Eviction>(index, tag, cache);
+        if (dirty)
+        {
+            cache.setDirty(index, way, true); // modified copy handed back by an exclusive level
         }
     }
 }
 
-void handleStore(Cache &cache, int index, int tag, Slot *hit)
+template <MissPolicy Miss, WritePolicy Write, EvictionPolicy Eviction>
+static void storeAccess(Cache &cache, int index, uint64_t tag, int hit)
 {
     cache.storeCount++;
-    if (hit)
+    if (hit >= 0)
     {
         cache.storeHits++;
-        hit->access_ts = cache.totalCycles;
-        if (cache.handleWrite == "write-back")
+        if (cache.timing.mshrs)
         {
-            hit->dirty = true;
-            cache.totalCycles++;
+            waitForFill(cache, blockAddress(cache, index, tag));
+        }
+        if (Write == WritePolicy::WriteBack)
+        {
+            cache.setDirty(index, hit, true);
+            cache.totalCycles += cache.timing.hitLatency;
+        }
+        else if (cache.nextLevel) // write-through policy
+        {
+            writeToNextLevel(cache, index, tag);
         }
         else // write-through policy
         {
-            cache.totalCycles += 100; // simulate cost of writing to memory and to cache
+            chargeWrite(cache, memoryCycles(cache.timing, 4), blockAddress(cache, index, tag)); // simulate cost of writing to memory and to cache
         }
+        touchBlock<Eviction>(cache, index, hit);
     }
     // store miss
     else
     {
         cache.storeMisses++;
-        if (cache.handleMiss == "no-write-allocate")
+        if (Miss == MissPolicy::NoWriteAllocate)
         {
-            cache.totalCycles += 100; // writes directly to memory
-            return;
-        }
-        // write-allocate policy
-        else
-        {
-            cache.totalCycles += 100 * (cache.numBytes / 4); // getting the block from memory
-            Slot *temp = findReplacementBlock(index, cache);
-            cache.totalCycles++; // time for updating cache
-            temp->valid = true;
-            temp->tag = tag;
-            if (cache.handleEviction == "lru")
+            if (cache.nextLevel)
             {
-                temp->access_ts = cache.totalCycles;
+                writeToNextLevel(cache, index, tag);
             }
-            else //fifo
+            else if (cache.victimCache && victimCacheStore(*cache.victimCache, cache, blockAddress(cache, index, tag)))
             {
-                temp->load_ts = cache.totalCycles;
+                // merged into the dirty copy in the victim cache
             }
-            if (cache.handleWrite == "write-back")
+            else
             {
-                temp->dirty = true;
-                // not stored in memory yet
+                chargeWrite(cache, memoryCycles(cache.timing, 4), blockAddress(cache, index, tag)); // writes directly to memory
             }
+            return;
+        }
+        // write-allocate policy
+        bool dirty = false;
+        if (cache.nextLevel)
+        {
+            dirty = fetchFromNextLevel(cache, index, tag);
+        }
+        else if (cache.victimCache && victimCacheTake(*cache.victimCache, cache, blockAddress(cache, index, tag), dirty))
+        {
+            // swapped back from the victim cache
+        }
+        else
+        {
+            // getting the block from memory
+            chargeFill(cache, memoryCycles(cache.timing, cache.numBytes), blockAddress(cache, index, tag));
+        }
+        int way = fillBlock<Write, Eviction>(index, tag, cache);
+        if (dirty)
+        {
+            cache.setDirty(index, way, true);
+        }
+        if (Write == WritePolicy::WriteBack)
+        {
+            cache.setDirty(index, way, true);
+            // not stored in memory yet
         }
     }
 }
 
-void cacheSimulator(Cache &cache, char loadStore, int address)
+template <MissPolicy Miss, WritePolicy Write, EvictionPolicy Eviction>
+static void simulateAccess(Cache &cache, char loadStore, uint64_t address)
 {
     // get block information
     int index = calculateIndex(address, cache);
-    int tag = calculateTag(address, cache);
+    uint64_t tag = calculateTag(address, cache);
 
     // find block with the corresponding address
-    Slot *hit = findBlock(tag, index, cache);
+    int hit = findBlock(tag, index, cache);
 
     if (loadStore == 'l') // load/read
     {
-        handleLoad(cache, index, tag, hit);
+        loadAccess<Write, Eviction>(cache, index, tag, hit);
     }
     else // store/write
     {
-        handleStore(cache, index, tag, hit);
+        storeAccess<Miss, Write, Eviction>(cache, index, tag, hit);
     }
 }
 
-Slot *findBlock(int tag, int index, Cache &cache)
+// pulls in the lines a lookup of a set touches: its tags, its valid word and the stamps the policy updates
+template <EvictionPolicy Eviction>
+static inline void prefetchSet(const Cache &cache, int index)
 {
-    // check index line for tag
-    Set &set = cache.sets[index];
-    for (Slot &slot : set.slots)
+    size_t slot = cache.slot(index, 0);
+    if (cache.tags)
     {
-        // check if the slot contains a valid block and if the tag matches
-        if (slot.valid && (slot.tag == tag))
-        {
-            // return block if found (hit)
-            return &slot;
-        }
+        __builtin_prefetch(cache.tags + slot);
     }
-    return nullptr;
+    else
+    {
+        __builtin_prefetch(cache.wideTags + slot);
+    }
+    __builtin_prefetch(cache.valid + static_cast<size_t>(index) * cache.maskWords);
+    __builtin_prefetch(Eviction == EvictionPolicy::LRU ? cache.accessTs + slot : cache.loadTs + slot, 1);
 }
 
-Slot *findReplacementBlock(int index, Cache &cache)
+// the batch loop, recording each access's outcome when Record is set
+template <MissPolicy Miss, WritePolicy Write, EvictionPolicy Eviction, bool Record>
+static inline void batchLoop(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count, AccessOutcome *outcomes)
 {
-    Slot *temp = nullptr;
-    // can fill in invalid slot
-    Set &set = cache.sets[index];
-    for (Slot &slot : set.slots)
+    int indices[BATCH_DECODE_SIZE];
+    uint64_t tags[BATCH_DECODE_SIZE];
+    for (size_t start = 0; start < count; start += BATCH_DECODE_SIZE)
     {
-        if (slot.valid == false)
+        size_t n = std::min(count - start, BATCH_DECODE_SIZE);
+        decodeAddresses(cache, addresses + start, n, indices, tags);
+        for (size_t i = 0; i < n && i < BATCH_PREFETCH_DISTANCE; i++)
+        {
+            prefetchSet<Eviction>(cache, indices[i]);
+        }
+
+        const char *ops = loadStore + start;
+        for (size_t i = 0; i < n; i++)
         {
-            temp = &slot;
-            return temp;
+            if (i + BATCH_PREFETCH_DISTANCE < n)
+            {
+                prefetchSet<Eviction>(cache, indices[i + BATCH_PREFETCH_DISTANCE]);
+            }
+            int hit = findBlock(tags[i], indices[i], cache);
+            // a miss in a full set evicts, unless it is a store that does not allocate
+            bool evicts = Record && hit < 0 && (ops[i] == 'l' || Miss == MissPolicy::WriteAllocate) &&
+                          cacheSetFull(cache, indices[i]);
+            if (ops[i] == 'l')
+            {
+                loadAccess<Write, Eviction>(cache, indices[i], tags[i], hit);
+            }
+            else
+            {
+                storeAccess<Miss, Write, Eviction>(cache, indices[i], tags[i], hit);
+            }
+            if (Record)
+            {
+                outcomes[start + i] = hit >= 0 ? AccessOutcome::Hit : evicts ? AccessOutcome::Eviction : AccessOutcome::Miss;
+            }
         }
     }
-    // no invalids, needs to evict
-    if (temp == nullptr)
+}
+
+template <MissPolicy Miss, WritePolicy Write, EvictionPolicy Eviction>
+static void simulateBatchAccess(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count)
+{
+    batchLoop<Miss, Write, Eviction, false>(cache, loadStore, addresses, count, nullptr);
+}
+
+template <MissPolicy Miss, WritePolicy Write, EvictionPolicy Eviction>
+static void simulateOutcomes(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count, AccessOutcome *outcomes)
+{
+    batchLoop<Miss, Write, Eviction, true>(cache, loadStore, addresses, count, outcomes);
+}
+
+// one row of a dispatch table: a function instantiated for the leading policies
+// given and for every eviction policy, in enum order
+#define EVICTION_ROW(function, ...)                                                                  \
+    {                                                                                                \
+        function<__VA_ARGS__, EvictionPolicy::LRU>, function<__VA_ARGS__, EvictionPolicy::FIFO>,     \
+        function<__VA_ARGS__, EvictionPolicy::PLRU>, function<__VA_ARGS__, EvictionPolicy::SRRIP>,   \
+        function<__VA_ARGS__, EvictionPolicy::BRRIP>, function<__VA_ARGS__, EvictionPolicy::Random>, \
+        function<__VA_ARGS__, EvictionPolicy::LFU>                                                   \
+    }
+
+AccessFunction selectAccessFunction(MissPolicy miss, WritePolicy write, EvictionPolicy eviction)
+{
+    // indexed [miss][write][eviction] in enum order
+    static const AccessFunction table[2][2][EVICTION_POLICY_COUNT] = {
+        {EVICTION_ROW(simulateAccess, MissPolicy::WriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(simulateAccess, MissPolicy::WriteAllocate, WritePolicy::WriteBack)},
+        {EVICTION_ROW(simulateAccess, MissPolicy::NoWriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(simulateAccess, MissPolicy::NoWriteAllocate, WritePolicy::WriteBack)},
+    };
+    return table[static_cast<int>(miss)][static_cast<int>(write)][static_cast<int>(eviction)];
+}
+
+BatchFunction selectBatchFunction(MissPolicy miss, WritePolicy write, EvictionPolicy eviction)
+{
+    // indexed [miss][write][eviction] in enum order
+    static const BatchFunction table[2][2][EVICTION_POLICY_COUNT] = {
+        {EVICTION_ROW(simulateBatchAccess, MissPolicy::WriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(simulateBatchAccess, MissPolicy::WriteAllocate, WritePolicy::WriteBack)},
+        {EVICTION_ROW(simulateBatchAccess, MissPolicy::NoWriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(simulateBatchAccess, MissPolicy::NoWriteAllocate, WritePolicy::WriteBack)},
+    };
+    return table[static_cast<int>(miss)][static_cast<int>(write)][static_cast<int>(eviction)];
+}
+
+static OutcomeFunction selectOutcomeFunction(MissPolicy miss, WritePolicy write, EvictionPolicy eviction)
+{
+    // indexed [miss][write][eviction] in enum order
+    static const OutcomeFunction table[2][2][EVICTION_POLICY_COUNT] = {
+        {EVICTION_ROW(simulateOutcomes, MissPolicy::WriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(simulateOutcomes, MissPolicy::WriteAllocate, WritePolicy::WriteBack)},
+        {EVICTION_ROW(simulateOutcomes, MissPolicy::NoWriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(simulateOutcomes, MissPolicy::NoWriteAllocate, WritePolicy::WriteBack)},
+    };
+    return table[static_cast<int>(miss)][static_cast<int>(write)][static_cast<int>(eviction)];
+}
+
+// PUBLIC ENTRY POINTS
+
+void handleLoad(Cache &cache, int index, uint64_t tag, int hit)
+{
+    // indexed [write][eviction] in enum order
+    typedef void (*LoadFunction)(Cache &, int, uint64_t, int);
+    static const LoadFunction table[2][EVICTION_POLICY_COUNT] = {
+        EVICTION_ROW(loadAccess, WritePolicy::WriteThrough),
+        EVICTION_ROW(loadAccess, WritePolicy::WriteBack),
+    };
+    table[static_cast<int>(cache.writePolicy)][static_cast<int>(cache.evictionPolicy)](cache, index, tag, hit);
+}
+
+void handleStore(Cache &cache, int index, uint64_t tag, int hit)
+{
+    // indexed [miss][write][eviction] in enum order
+    typedef void (*StoreFunction)(Cache &, int, uint64_t, int);
+    static const StoreFunction table[2][2][EVICTION_POLICY_COUNT] = {
+        {EVICTION_ROW(storeAccess, MissPolicy::WriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(storeAccess, MissPolicy::WriteAllocate, WritePolicy::WriteBack)},
+        {EVICTION_ROW(storeAccess, MissPolicy::NoWriteAllocate, WritePolicy::WriteThrough),
+         EVICTION_ROW(storeAccess, MissPolicy::NoWriteAllocate, WritePolicy::WriteBack)},
+    };
+    table[static_cast<int>(cache.missPolicy)][static_cast<int>(cache.writePolicy)][static_cast<int>(cache.evictionPolicy)](cache, index, tag, hit);
+}
+
+void cacheSimulator(Cache &cache, char loadStore, uint64_t address)
+{
+    // one indirect call to the instantiation chosen in cacheSetUp
+    cache.simulate(cache, loadStore, address);
+}
+
+void cacheSimulateBatch(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count)
+{
+    cache.simulateBatch(cache, loadStore, addresses, count);
+}
+
+void cacheSimulateOutcomes(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count, AccessOutcome *outcomes)
+{
+    selectOutcomeFunction(cache.missPolicy, cache.writePolicy, cache.evictionPolicy)(cache, loadStore, addresses, count, outcomes);
+}
+
+void cachePrefetchSet(const Cache &cache, int index)
+{
+    if (cache.evictionPolicy == EvictionPolicy::LRU)
+    {
+        prefetchSet<EvictionPolicy::LRU>(cache, index);
+    }
+    else
+    {
+        prefetchSet<EvictionPolicy::FIFO>(cache, index);
+    }
+}
+
+int cacheValidWays(const Cache &cache, int index)
+{
+    const uint64_t *words = cache.valid + static_cast<size_t>(index) * cache.maskWords;
+    int validWays = 0;
+    for (int w = 0; w < cache.maskWords; w++)
     {
-        // get replacement blocks
-        if (cache.handleEviction == "lru")
+        validWays += __builtin_popcountll(words[w]);
+    }
+    return validWays;
+}
+
+bool cacheSetFull(const Cache &cache, int index)
+{
+    return cacheValidWays(cache, index) == cache.numBlocks;
+}
+
+int findBlock(uint64_t tag, int index, Cache &cache)
+{
+    // check index line for tag with the kernel picked in cacheSetUp
+    const uint64_t *valid = cache.valid + static_cast<size_t>(index) * cache.maskWords;
+    if (cache.tags)
+    {
+        if ((tag >> 32) != 0)
         {
-            temp = findLRUBlock(cache.sets[index], cache);
+            return -1; // every stored tag fits in 32 bits
         }
-        else //fifo
+        const uint32_t *tags = cache.tags + cache.slot(index, 0);
+        if (cache.tagMatch == tagMatchScalar<uint32_t>)
         {
-            temp = findFIFOBlock(cache.sets[index], cache);
+            return tagMatchScalar(tags, valid, cache.numBlocks, static_cast<uint32_t>(tag)); // inlined for low associativity
         }
+        return cache.tagMatch(tags, valid, cache.numBlocks, static_cast<uint32_t>(tag));
     }
-    return temp;
+    const uint64_t *tags = cache.wideTags + cache.slot(index, 0);
+    if (cache.wideTagMatch == tagMatchScalar<uint64_t>)
+    {
+        return tagMatchScalar(tags, valid, cache.numBlocks, tag);
+    }
+    return cache.wideTagMatch(tags, valid, cache.numBlocks, tag);
+}
+
+uint64_t blockAddress(const Cache &cache, int index, uint64_t tag)
+{
+    return (tag << (cache.offsetBits + cache.indexBits)) | (static_cast<uint64_t>(index) << cache.offsetBits);
+}
+
+void cacheInvalidate(Cache &cache, int index, int way)
+{
+    cache.setValid(index, way, false);
+    cache.setDirty(index, way, false);
 }
 
-Slot *findLRUBlock(Set &set, Cache &cache)
+template <WritePolicy Write, EvictionPolicy Eviction>
+static int insertBlock(Cache &cache, int index, uint64_t tag, bool dirty)
 {
-    Slot *temp = &(set.slots[0]);
-    for (Slot &slot : set.slots)
+    int way = fillBlock<Write, Eviction>(index, tag, cache);
+    if (dirty)
     {
-        // find min
-        if (slot.access_ts < temp->access_ts)
-        {
-            temp = &slot;
-        }
+        cache.setDirty(index, way, true);
     }
+    return way;
+}
+
+int cacheInsert(Cache &cache, int index, uint64_t tag, bool dirty)
+{
+    // indexed [write][eviction] in enum order
+    typedef int (*InsertFunction)(Cache &, int, uint64_t, bool);
+    static const InsertFunction table[2][EVICTION_POLICY_COUNT] = {
+        EVICTION_ROW(insertBlock, WritePolicy::WriteThrough),
+        EVICTION_ROW(insertBlock, WritePolicy::WriteBack),
+    };
+    return table[static_cast<int>(cache.writePolicy)][static_cast<int>(cache.evictionPolicy)](cache, index, tag, dirty);
+}
 
-    if (temp->dirty && cache.handleWrite == "write-back")
+template <WritePolicy Write, EvictionPolicy Eviction>
+static int prefetchBlock(Cache &cache, int index, uint64_t tag, uint64_t &victim)
+{
+    // a full set evicts the way replacementBlock picks; its tag is still in place until placeBlock
+    const uint64_t *valid = cache.valid + static_cast<size_t>(index) * cache.maskWords;
+    bool full = true;
+    for (int word = 0; word < cache.maskWords && full; word++)
     {
-        temp->valid = false;
-        temp->dirty = false;
-        cache.totalCycles += 100 * cache.numBytes / 4; // store to memory
+        int ways = std::min(64, cache.numBlocks - word * 64);
+        full = valid[word] == (ways == 64 ? ~0ULL : (1ULL << ways) - 1);
     }
+    int way = replacementBlock<Write, Eviction>(index, cache);
+    victim = full ? blockAddress(cache, index, cache.tagAt(cache.slot(index, way))) : NO_VICTIM;
+    placeBlock<Eviction>(index, way, tag, cache);
+    return way;
+}
 
-    return temp;
+int cachePrefetchFill(Cache &cache, int index, uint64_t tag, uint64_t &victim)
+{
+    // indexed [write][eviction] in enum order
+    typedef int (*PrefetchFunction)(Cache &, int, uint64_t, uint64_t &);
+    static const PrefetchFunction table[2][EVICTION_POLICY_COUNT] = {
+        EVICTION_ROW(prefetchBlock, WritePolicy::WriteThrough),
+        EVICTION_ROW(prefetchBlock, WritePolicy::WriteBack),
+    };
+    return table[static_cast<int>(cache.writePolicy)][static_cast<int>(cache.evictionPolicy)](cache, index, tag, victim);
+}
+
+int findReplacementBlock(int index, Cache &cache)
+{
+    // indexed [write][eviction] in enum order
+    typedef int (*ReplacementFunction)(int, Cache &);
+    static const ReplacementFunction table[2][EVICTION_POLICY_COUNT] = {
+        EVICTION_ROW(replacementBlock, WritePolicy::WriteThrough),
+        EVICTION_ROW(replacementBlock, WritePolicy::WriteBack),
+    };
+    return table[static_cast<int>(cache.writePolicy)][static_cast<int>(cache.evictionPolicy)](index, cache);
 }
 
-Slot *findFIFOBlock(Set &set, Cache &cache) {
-    Slot *temp = &(set.slots[0]);
-    for (Slot &slot : set.slots)
+int findLRUBlock(int index, Cache &cache)
+{
+    if (cache.writePolicy == WritePolicy::WriteBack)
     {
-        // find min
-        if (slot.load_ts < temp->load_ts)
-        {
-            temp = &slot;
-        }
+        return lruBlock<WritePolicy::WriteBack>(index, cache);
     }
+    return lruBlock<WritePolicy::WriteThrough>(index, cache);
+}
 
-    if (temp->dirty && cache.handleWrite == "write-back")
+int findFIFOBlock(int index, Cache &cache)
+{
+    if (cache.writePolicy == WritePolicy::WriteBack)
     {
-        temp->valid = false;
-        temp->dirty = false;
-        cache.totalCycles += 100 * cache.numBytes / 4; // store to memory
+        return fifoBlock<WritePolicy::WriteBack>(index, cache);
     }
-
-    return temp;
-}
\ No newline at end of file
+    return fifoBlock<WritePolicy::WriteThrough>(index, cache);
+}
@@ -1,37 +1,132 @@
 #ifndef CACHESIMULATOR_H
 #define CACHESIMULATOR_H
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
-// STRUCTS TO REPRESENT THE CACHE
+#include "tag_match.h"
+#include "timing.h"
+
+// CACHE POLICIES (resolved once from the command-line strings in cacheSetUp)
+
+enum class MissPolicy
+{
+    WriteAllocate,
+    NoWriteAllocate
+};
+
+enum class WritePolicy
+{
+    WriteThrough,
+    WriteBack
+};
+
+enum class EvictionPolicy
+{
+    LRU,    // least recently used, exact
+    FIFO,   // first filled
+    PLRU,   // tree pseudo-LRU: numBlocks - 1 bits per set
+    SRRIP,  // static re-reference interval prediction: 2 bits per way
+    BRRIP,  // bimodal RRIP: SRRIP that mostly inserts at the distant interval
+    Random, // uniformly random way
+    LFU     // least frequently used, oldest fill on ties
+};
+
+// number of EvictionPolicy values, the last dimension of the dispatch tables
+static const int EVICTION_POLICY_COUNT = 7;
+// largest re-reference prediction value of the RRIP policies (2-bit counters)
+static const uint8_t RRIP_MAX = 3;
+// BRRIP inserts at RRIP_MAX - 1 instead of RRIP_MAX once in this many fills
+static const int BRRIP_LONG_CHANCE = 32;
 
 /**
- * Struct representing a cache slot.
- * Contains information about a single block in the cache.
+ * How a level of a cache hierarchy relates to the level above it.
  */
-struct Slot
+enum class InclusionPolicy
 {
-    int tag;            // The tag of the block in memory
-    bool valid;         // Indicates if the block is valid
-    bool dirty;         // Indicates if the block has been modified
-    uint32_t load_ts;   // Timestamp when the block was loaded (used for FIFO)
-    uint32_t access_ts; // Timestamp of the last access (used for LRU)
+    NINE,      // non-inclusive non-exclusive: fills go to every level, evictions are independent
+    Inclusive, // evicting a block also invalidates it in every level above
+    Exclusive  // holds only blocks evicted from the level above, and hands them back on a hit
 };
 
+struct Cache;
+struct Prefetcher;
+struct MissClassifier;
+struct HotSpots;
+struct WayPartition;
+struct VictimCache;
+
+/**
+ * Simulates one access; instantiated once per policy combination.
+ */
+typedef void (*AccessFunction)(Cache &cache, char loadStore, uint64_t address);
+
 /**
- * Struct representing a set of slots in the cache.
- * A cache set contains multiple slots for storing blocks.
+ * Simulates a run of accesses; instantiated once per policy combination.
  */
-struct Set
+typedef void (*BatchFunction)(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count);
+
+/**
+ * What one access did, as reported by cacheSimulateOutcomes.
+ */
+enum class AccessOutcome : uint8_t
 {
-    std::vector<Slot> slots; // A vector of slots in the set
+    Hit,
+    Miss,    // A miss that replaced no valid block
+    Eviction // A miss whose fill evicted a valid block
+};
+
+/**
+ * Simulates a run of accesses and reports each one's outcome; instantiated once per policy combination.
+ */
+typedef void (*OutcomeFunction)(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count, AccessOutcome *outcomes);
+
+// STRUCTS TO REPRESENT THE CACHE
+
+// host cache line size; each set's tag array starts on its own line
+static const int CACHE_LINE_BYTES = 64;
+// sets with more ways than this keep a replacement order list instead of scanning timestamps
+static const int ORDER_LIST_MIN_WAYS = 16;
+// accesses a batch decodes at a time, sized so the decoded indices and tags stay in L1
+static const size_t BATCH_DECODE_SIZE = 256;
+// how many accesses ahead the batch loop prefetches a set
+static const size_t BATCH_PREFETCH_DISTANCE = 8;
+// victim reported by cachePrefetchFill when the set had a free way
+static const uint64_t NO_VICTIM = UINT64_MAX;
+
+/**
+ * Releases storage obtained from std::aligned_alloc.
+ */
+struct AlignedFree
+{
+    void operator()(void *p) const;
 };
 
 /**
  * Struct representing the cache itself.
- * The cache consists of multiple sets.
+ * The cache consists of numSets sets of numBlocks ways each, stored as
+ * structure-of-arrays in one 64-byte aligned allocation made by cacheSetUp:
+ *
+ * - tags, loadTs and accessTs hold one entry per way, and each set occupies
+ *   wayStride consecutive entries, so a set's tags are a whole number of
+ *   host cache lines. Tags are 32-bit while every tag seen fits; the first
+ *   wider tag moves them to the 64-bit wideTags array for good.
+ * - valid and dirty hold one bit per way, maskWords 64-bit words per set.
+ *   The inverted valid mask doubles as the free-slot bitmask.
+ * - for LRU and FIFO sets wider than ORDER_LIST_MIN_WAYS, orderPrev/orderNext
+ *   link each set's ways into a doubly-linked replacement order list (most
+ *   recently accessed for LRU, most recently filled for FIFO, at orderHead),
+ *   so the victim is read from orderTail instead of scanning the timestamps.
+ * - the other policies keep their own compact state, allocated only for
+ *   them: plruBits (a tree of numBlocks - 1 bits in maskWords words per set),
+ *   rrpv (one 2-bit prediction per way, in a byte), or for LFU the access
+ *   count of each way in accessTs with the fill time in loadTs.
+ *
+ * Ways are addressed by (set index, way number); slot(index, way) gives the
+ * position of a way in the per-way arrays.
  * The original number of hits and misses and cycles is zero.
  */
 struct Cache
@@ -40,19 +135,121 @@ struct Cache
     int numSets;
     int numBlocks;
     int numBytes; // block size
+    int offsetBits; // log2(numBytes), precomputed in cacheSetUp
+    int indexBits;  // log2(numSets), precomputed in cacheSetUp
+    int indexMask;  // numSets - 1
+    int wayBits;    // log2(numBlocks), the depth of the PLRU tree
     std::string handleMiss;
     std::string handleWrite;
     std::string handleEviction;
-    std::vector<Set> sets; // the different blocks in the cache
+    MissPolicy missPolicy;
+    WritePolicy writePolicy;
+    EvictionPolicy evictionPolicy;
+    AccessFunction simulate; // access path specialized for the policies above
+    BatchFunction simulateBatch; // The same path over a run of accesses
+    TagMatchFunction tagMatch; // findBlock kernel chosen for numBlocks and the host CPU
+    WideTagMatchFunction wideTagMatch; // The same kernel for 64-bit tags
+
+    // CACHE CONTENTS
+    int wayStride = 0;            // Per-way entries per set (numBlocks rounded up to a cache line of tags)
+    int maskWords = 0;            // 64-bit valid/dirty words per set
+    uint32_t *tags = nullptr;     // The tag of the block in each way, while every tag fits in 32 bits
+    uint64_t *wideTags = nullptr; // The tag of the block in each way, once one does not (tags is then null)
+    uint32_t *loadTs = nullptr;   // Timestamp when each block was loaded (used for FIFO)
+    uint32_t *accessTs = nullptr; // Timestamp of the last access to each block (used for LRU)
+    uint64_t *valid = nullptr;    // Bit set if the way holds a valid block
+    uint64_t *dirty = nullptr;    // Bit set if the block has been modified
+    uint64_t *plruBits = nullptr; // PLRU: per set, node n of the tree is bit n (1: the victim is in its upper half)
+    uint8_t *rrpv = nullptr;      // SRRIP/BRRIP: re-reference prediction of each way (RRIP_MAX: evict first)
+    uint64_t randomState = 0;     // Random/BRRIP: xorshift state, seeded in cacheSetUp so runs repeat
+    bool orderList = false;       // Indicates if the replacement order list below is kept
+    int *orderPrev = nullptr;     // Next more recent way in the set's order list (-1 at the head)
+    int *orderNext = nullptr;     // Next older way in the set's order list (-1 at the tail)
+    int *orderHead = nullptr;     // Most recent way of each set
+    int *orderTail = nullptr;     // Replacement victim of each full set
+    std::unique_ptr<uint8_t, AlignedFree> storage; // The single allocation backing the arrays above
+    size_t storageBytes = 0;                       // Bytes of it the arrays use
+    size_t storageCapacity = 0;                    // Size of that allocation, kept when a set-up needs no more
+
+    /**
+     * Position of a way in the per-way arrays.
+     */
+    size_t slot(int index, int way) const
+    {
+        return static_cast<size_t>(index) * wayStride + way;
+    }
+
+    uint64_t tagAt(size_t slot) const
+    {
+        return wideTags ? wideTags[slot] : tags[slot];
+    }
+
+    bool isValid(int index, int way) const
+    {
+        return (valid[static_cast<size_t>(index) * maskWords + (way >> 6)] >> (way & 63)) & 1;
+    }
+
+    bool isDirty(int index, int way) const
+    {
+        return (dirty[static_cast<size_t>(index) * maskWords + (way >> 6)] >> (way & 63)) & 1;
+    }
+
+    void setValid(int index, int way, bool value)
+    {
+        setBit(valid, index, way, value);
+    }
+
+    void setDirty(int index, int way, bool value)
+    {
+        setBit(dirty, index, way, value);
+    }
+
+private:
+    void setBit(uint64_t *mask, int index, int way, bool value)
+    {
+        uint64_t &word = mask[static_cast<size_t>(index) * maskWords + (way >> 6)];
+        uint64_t bit = uint64_t(1) << (way & 63);
+        word = value ? (word | bit) : (word & ~bit);
+    }
+
+public:
+    // HIERARCHY (linked by hierarchySetUp; a standalone cache talks to memory directly)
+    Cache *nextLevel = nullptr; // Level misses and write-backs are sent to, or memory if null
+    Cache *prevLevel = nullptr; // Level whose misses this cache serves
+    InclusionPolicy inclusion = InclusionPolicy::NINE; // Relation to prevLevel
+
+    // PREFETCHING AND INSTRUMENTATION (see prefetch.h, miss_classifier.h and hotspot.h); the access paths above never read them
+    Prefetcher *prefetcher = nullptr;         // Prefetcher attached by prefetcherAttach, or null
+    MissClassifier *missClassifier = nullptr; // Classifier attached by missClassifierAttach, or null
+    HotSpots *hotSpots = nullptr;             // Histograms attached by hotSpotAttach, or null
+
+    // WAY PARTITIONING AND VICTIM CACHE (see partition.h and victim_cache.h); only the miss path reads them
+    WayPartition *partition = nullptr;   // Way masks attached by partitionAttach, or null
+    VictimCache *victimCache = nullptr;  // Victim cache attached by victimCacheAttach, or null
+
+    // TIMING (see timing.h); replacement stamps come from accessClock, not from totalCycles
+    TimingModel timing;
+    uint32_t accessClock = 0;           // Logical time, advanced once per stamp and renumbered before it wraps
+    std::vector<uint64_t> mshrDone;     // Per MSHR: cycle its fill completes
+    std::vector<uint64_t> mshrAddress;  // Per MSHR: block being filled
+    std::vector<uint64_t> writeDone;    // Write buffer ring: cycle each buffered write completes
+    std::vector<uint64_t> writeAddress; // Write buffer ring: block each buffered write goes to
+    int writeNext = 0;                  // Oldest entry of the write buffer ring
 
     // CACHE STATISTICS
-    int loadCount = 0;
-    int storeCount = 0;
-    int loadHits = 0;
-    int loadMisses = 0;
-    int storeHits = 0;
-    int storeMisses = 0;
-    int totalCycles = 0;
+    uint64_t loadCount = 0;
+    uint64_t storeCount = 0;
+    uint64_t loadHits = 0;
+    uint64_t loadMisses = 0;
+    uint64_t storeHits = 0;
+    uint64_t storeMisses = 0;
+    uint64_t totalCycles = 0;
+    uint64_t writeBacks = 0;        // Dirty blocks written to the next level or memory on eviction
+    uint64_t backInvalidations = 0; // Blocks invalidated because an inclusive level below evicted them
+    uint64_t bufferedWrites = 0;    // Writes that took a write buffer entry
+    uint64_t coalescedWrites = 0;   // Writes merged into a waiting entry instead
+    uint64_t writeStalls = 0;       // Writes that found the write buffer full
+    uint64_t writeStallCycles = 0;  // Cycles they waited for an entry
 };
 
 /**
@@ -69,6 +266,23 @@ void displayStatistics(Cache &cache);
  */
 bool checkPowTwo(int x);
 
+/**
+ * Computes the base-2 logarithm of a power of two with integer operations.
+ * @param x a positive power of 2
+ * @return the number of the bit set in x
+ */
+int log2PowTwo(int x);
+
+/**
+ * Resolves an eviction policy name.
+ *
+ * @param name The eviction policy string ("lru", "fifo", "plru", "srrip", "brrip", "random", "lfu").
+ * @param policy Receives the policy.
+ *
+ * @return true if the name is a known policy.
+ */
+bool parseEvictionPolicy(const std::string &name, EvictionPolicy &policy);
+
 /**
  * This function validates the provided arguments for cache simulator configuration.
  *
@@ -77,7 +291,7 @@ bool checkPowTwo(int x);
  * @param numBytes The number of bytes in each block cache (must be greater than 4 and a power of 2).
  * @param handleMiss The string describing how to handle cache misses ("write-allocate", "no-write-allocate").
  * @param handleWrite The string describing how to handle cache writes ("write-through", "write-back").
- * @param handleEviction The string describing the eviction policy ("lru", "fifo").
+ * @param handleEviction The string describing the eviction policy ("lru", "fifo", "plru", "srrip", "brrip", "random", "lfu").
  *
  * @return int 0 for success, 1 for invalid input.
  */
@@ -91,7 +305,7 @@ int validateArguments(int numSets, int numBlocks, int numBytes, std::string hand
  *
  * @return int The index of the cache set where the memory block might be located.
  */
-int calculateIndex(int address, Cache &cache);
+int calculateIndex(uint64_t address, Cache &cache);
 
 /**
  * Computes the cache tag for a given memory address.
@@ -99,12 +313,30 @@ int calculateIndex(int address, Cache &cache);
  * @param address The memory address for which the cache tag is being computed.
  * @param cache Reference to the Cache object that contains cache parameters.
  *
- * @return int The tag for the specified memory address.
+ * @return uint64_t The tag for the specified memory address.
  */
-int calculateTag(int address, Cache &cache);
+uint64_t calculateTag(uint64_t address, Cache &cache);
+
+/**
+ * Computes the cache index and tag of a batch of addresses.
+ * The loop is plain shifts and masks over contiguous arrays, so the compiler
+ * vectorizes it.
+ *
+ * @param cache Reference to the Cache object that contains cache parameters.
+ * @param addresses The memory addresses to decode.
+ * @param count The number of addresses.
+ * @param indices Output array receiving the index of each address.
+ * @param tags Output array receiving the tag of each address.
+ */
+void decodeAddresses(const Cache &cache, const uint64_t *addresses, size_t count, int *indices, uint64_t *tags);
 
 /**
  * Sets up the cache parameters and initializes the cache structure.
+ * A cache can be set up again with another configuration: its allocation is
+ * reused when it is large enough, anything attached to it is detached, and
+ * its statistics are left for cacheClearStatistics. A new allocation is made
+ * before anything changes, so if it throws std::bad_alloc the cache is left
+ * as it was.
  *
  * @param cache Reference to the Cache structure to be set up.
  * @param numSets The number of sets in the cache.
@@ -116,6 +348,55 @@ int calculateTag(int address, Cache &cache);
  */
 void cacheSetUp(Cache &cache, int numSets, int blockSize, int numBytes, std::string handleMiss, std::string handleWrite, std::string handleEviction);
 
+/**
+ * Clears a cache's statistics, keeping its contents. Outstanding misses and
+ * buffered writes are completed first, so cycle counting restarts from an idle cache.
+ *
+ * @param cache Reference to the Cache.
+ */
+void cacheClearStatistics(Cache &cache);
+
+/**
+ * Moves a cache to 64-bit tags, as the first tag wider than 32 bits does.
+ * Does nothing if the tags are already 64-bit.
+ *
+ * @param cache Reference to the Cache.
+ */
+void cacheWidenTags(Cache &cache);
+
+/**
+ * Empties a cache and clears its statistics, keeping its configuration,
+ * timing model, links to other levels and whatever is attached to it. An
+ * attached partition and victim cache are emptied too; prefetchers and
+ * instrumentation keep what they have learned. Only the valid and dirty bits
+ * are cleared: the rest of a way's state is rewritten by the fill that next
+ * makes it valid, so the cache behaves as a new one without its arrays being
+ * rebuilt or the allocator being touched.
+ *
+ * @param cache Reference to the Cache to reset, already set up by cacheSetUp.
+ */
+void cacheReset(Cache &cache);
+
+/**
+ * Selects the access path specialized for a policy combination.
+ *
+ * @param miss The miss policy.
+ * @param write The write policy.
+ * @param eviction The eviction policy.
+ * @return The instantiation of the simulator core for those policies.
+ */
+AccessFunction selectAccessFunction(MissPolicy miss, WritePolicy write, EvictionPolicy eviction);
+
+/**
+ * Selects the batch access path specialized for a policy combination.
+ *
+ * @param miss The miss policy.
+ * @param write The write policy.
+ * @param eviction The eviction policy.
+ * @return The batch instantiation of the simulator core for those policies.
+ */
+BatchFunction selectBatchFunction(MissPolicy miss, WritePolicy write, EvictionPolicy eviction);
+
 /**
  * Main function for simulating cache operations.
  *
@@ -123,84 +404,161 @@ void cacheSetUp(Cache &cache, int numSets, int blockSize, int numBytes, std::str
  * @param loadstore A character indicating the operation to perform: 'l' for load, 's' for store.
  * @param address The memory address involved in the load/store operation.
  */
-void cacheSimulator(Cache &cache, char loadStore, int address);
+void cacheSimulator(Cache &cache, char loadStore, uint64_t address);
 
 /**
- * Find a block in the cache.
- * @param tag The tag of the block to find
- * @param index The index of the set to search
- * @param cache The cache to search in
- * @return A block if found, or null if not found.
+ * Simulates a run of accesses, with the same results as calling cacheSimulator
+ * on each in turn. Addresses are decoded in blocks of BATCH_DECODE_SIZE, and
+ * the sets of upcoming accesses are prefetched while earlier ones are simulated.
+ *
+ * @param cache Reference to the Cache structure being simulated.
+ * @param loadStore The operation of each access: 'l' for load, 's' for store.
+ * @param addresses The memory address of each access.
+ * @param count The number of accesses.
  */
-Slot *findBlock(int tag, int index, Cache &cache);
+void cacheSimulateBatch(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count);
+
+/**
+ * Simulates a run of accesses through the cache's own batched path, as
+ * cacheSimulateBatch does before anything swaps its access functions, and
+ * records what each access did. Instrumentation that only needs per-access
+ * outcomes wraps this instead of the single-access path, keeping the batched
+ * decoding and set prefetching.
+ *
+ * @param cache Reference to the Cache structure being simulated.
+ * @param loadStore The operation of each access: 'l' for load, 's' for store.
+ * @param addresses The memory address of each access.
+ * @param count The number of accesses.
+ * @param outcomes Receives the outcome of each access.
+ */
+void cacheSimulateOutcomes(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count, AccessOutcome *outcomes);
+
+/**
+ * Pulls the host cache lines a lookup of a set touches into the host's caches,
+ * as the batch path does for upcoming accesses. For access paths that wrap
+ * cacheSimulator and look ahead in a batch themselves.
+ *
+ * @param cache Reference to the Cache.
+ * @param index The index of the set.
+ */
+void cachePrefetchSet(const Cache &cache, int index);
+
+/**
+ * Counts the ways of a set that hold a valid block. A miss that fills the set
+ * without changing the count evicted a block, even when some ways are still
+ * invalid, as a partitioned cache does.
+ *
+ * @param cache Reference to the Cache.
+ * @param index The index of the set.
+ *
+ * @return int The number of valid ways.
+ */
+int cacheValidWays(const Cache &cache, int index);
+
+/**
+ * Checks whether every way of a set holds a valid block, so that a miss
+ * which allocates evicts one.
+ *
+ * @param cache Reference to the Cache.
+ * @param index The index of the set.
+ *
+ * @return true if the set is full.
+ */
+bool cacheSetFull(const Cache &cache, int index);
 
 /**
  * Find a block in the cache.
  * @param tag The tag of the block to find
  * @param index The index of the set to search
  * @param cache The cache to search in
- * @return A block if found, or false if not found.
+ * @return The way holding the block if found, or -1 if not found.
  */
-Slot *getBlock(int tag, int index, Cache &cache);
+int findBlock(uint64_t tag, int index, Cache &cache);
 
 /**
- * Find a block in the cache.
+ * Reconstructs the address of the first byte of a cached block.
+ * @param cache The cache holding the block
+ * @param index The index of the block's set
+ * @param tag The tag of the block
+ * @return The block's address.
+ */
+uint64_t blockAddress(const Cache &cache, int index, uint64_t tag);
+
+/**
+ * Drops a block from the cache without writing it back.
+ * @param cache The cache holding the block
+ * @param index The index of the block's set
+ * @param way The way holding the block
+ */
+void cacheInvalidate(Cache &cache, int index, int way);
+
+/**
+ * Places a block in the cache through the replacement path, evicting a
+ * block if the set is full, and stamps it as the most recent access.
+ * Used by hierarchy levels that receive blocks from the level above.
+ * @param cache The cache to fill
+ * @param index The index of the set to fill
+ * @param tag The tag of the block
+ * @param dirty Whether the block holds modified data
+ * @return The way the block was placed in.
+ */
+int cacheInsert(Cache &cache, int index, uint64_t tag, bool dirty);
+
+/**
+ * Places a block fetched ahead of demand through the replacement path, as a
+ * miss would, without counting an access. Only for a standalone cache.
+ * @param cache The cache to fill
+ * @param index The index of the set to fill
+ * @param tag The tag of the block
+ * @param victim Receives the address of the valid block evicted, or NO_VICTIM
+ * @return The way the block was placed in.
+ */
+int cachePrefetchFill(Cache &cache, int index, uint64_t tag, uint64_t &victim);
+
+/**
+ * Find a way to fill in a set, evicting a block if the set is full.
  * @param index The index of the set to search
  * @param cache The cache to search in
- * @return replacement block being used.
+ * @return replacement way being used.
  */
-
-Slot *findReplacementBlock(int index, Cache &cache);
+int findReplacementBlock(int index, Cache &cache);
 
 /**
  * Handles a load.
  *
- * @param tag The tag of the address that caused the miss.
+ * @param cache Reference to the Cache structure containing the sets.
  * @param index The index of the cache set being accessed.
- * @param cache Reference to the Cache structure containing the sets and slots.
- * @param loadstore A character indicating the operation to perform: 'l' for load, 's' for store.
- * @param block Reference to the relevant Slot structure.
+ * @param tag The tag of the address being loaded.
+ * @param hit The way holding the block, or -1 on a miss.
  */
-void handleLoad(Cache &cache, char loadStore, int index, int tag, Slot *block);
+void handleLoad(Cache &cache, int index, uint64_t tag, int hit);
 
 /**
  * Handles a store.
  *
- * @param tag The tag of the address that caused the miss.
+ * @param cache Reference to the Cache structure containing the sets.
  * @param index The index of the cache set being accessed.
- * @param cache Reference to the Cache structure containing the sets and slots.
- * @param loadstore A character indicating the operation to perform: 'l' for load, 's' for store.
- * @param block Reference to the relevant Slot structure.
+ * @param tag The tag of the address being stored.
+ * @param hit The way holding the block, or -1 on a miss.
  */
-void handleStore(Cache &cache, int index, int tag, Slot *block);
+void handleStore(Cache &cache, int index, uint64_t tag, int hit);
 
 /**
- * Handles a miss by locating a suitable slot in the cache.
+ * Finds the Least Recently Used (LRU) block in a given set and evicts it.
  *
- * @param tag The tag of the address that caused the miss.
- * @param index The index of the cache set being accessed.
- * @param cache Reference to the Cache structure containing the sets and slots.
- * @param block Reference to the Slot structure to fill in with the new data.
- * @param loadstore A character indicating the operation to perform: 'l' for load, 's' for store.
+ * @param index The index of the set to be searched.
+ * @param cache Reference to the Cache structure containing the sets.
+ * @return The way that is the least recently used.
  */
-void handleMiss(int tag, int index, Cache &cache, char loadStore);
+int findLRUBlock(int index, Cache &cache);
 
 /**
- * Finds the Least Recently Used (LRU) block in a given set.
+ * Finds the first loaded block in a given set and evicts it.
  *
- * @param set Reference to the Set containing the slots to be searched.
- * @param cache Reference to the Cache structure containing the sets and slots.
- * @return Pointer to the Slot that is the least recently used.
- */
-Slot *findLRUBlock(Set &set, Cache &cache);
-
-/**
- * Finds the first loaded block in a given set. 
- * 
- * @param set Reference to the Set containing the slots to be searched.
- * @param cache Reference to the Cache structure containing the sets and slots.
- * @return Pointer to the Slot that was loaded first in the set. 
+ * @param index The index of the set to be searched.
+ * @param cache Reference to the Cache structure containing the sets.
+ * @return The way that was loaded first in the set.
  */
-Slot *findFIFOBlock(Set &set, Cache &cache);
+int findFIFOBlock(int index, Cache &cache);
 
 #endif // CACHESIMULATOR_H
\ No newline at end of file
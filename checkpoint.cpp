@@ -0,0 +1,122 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+int checkpointSave(const Cache &cache, const char *path)
+{
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    header.wideTags = cache.tags ? 0 : 1;
+    header.numSets = cache.numSets;
+    header.numBlocks = cache.numBlocks;
+    header.numBytes = cache.numBytes;
+    header.missPolicy = static_cast<uint8_t>(cache.missPolicy);
+    header.writePolicy = static_cast<uint8_t>(cache.writePolicy);
+    header.evictionPolicy = static_cast<uint8_t>(cache.evictionPolicy);
+    header.accessClock = cache.accessClock;
+    header.randomState = cache.randomState;
+    header.storageBytes = cache.storageBytes;
+    const uint64_t counters[9] = {cache.loadCount, cache.storeCount, cache.loadHits, cache.loadMisses, cache.storeHits,
+                                  cache.storeMisses, cache.totalCycles, cache.writeBacks, cache.backInvalidations};
+    std::memcpy(header.counters, counters, sizeof(counters));
+
+    std::FILE *file = std::fopen(path, "wb");
+    if (file == nullptr)
+    {
+        std::cerr << "Could not create checkpoint " << path << ". Exiting.\n";
+        return 1;
+    }
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(cache.storage.get(), 1, cache.storageBytes, file) == cache.storageBytes;
+    if (std::fclose(file) != 0 || !written)
+    {
+        std::cerr << "Could not write checkpoint " << path << ". Exiting.\n";
+        return 1;
+    }
+    return 0;
+}
+
+// checks that a checkpoint belongs to a cache set up like this one
+static int checkHeader(const CheckpointHeader &header, const Cache &cache, const char *path)
+{
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 || header.version != CHECKPOINT_VERSION)
+    {
+        std::cerr << path << " is not a csim checkpoint. Exiting.\n";
+        return 1;
+    }
+    if (header.numSets != cache.numSets || header.numBlocks != cache.numBlocks || header.numBytes != cache.numBytes ||
+        header.missPolicy != static_cast<uint8_t>(cache.missPolicy) ||
+        header.writePolicy != static_cast<uint8_t>(cache.writePolicy) ||
+        header.evictionPolicy != static_cast<uint8_t>(cache.evictionPolicy))
+    {
+        std::cerr << "Checkpoint " << path << " was taken with a different cache configuration. Exiting.\n";
+        return 1;
+    }
+    return 0;
+}
+
+int checkpointRestore(Cache &cache, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Could not open checkpoint " << path << ". Exiting.\n";
+        return 1;
+    }
+    struct stat info;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(CheckpointHeader))
+    {
+        map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "Could not read checkpoint " << path << ". Exiting.\n";
+        return 1;
+    }
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(map);
+    CheckpointHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    int status = checkHeader(header, cache, path);
+    if (status == 0)
+    {
+        if (header.wideTags)
+        {
+            cacheWidenTags(cache);
+        }
+        if (header.storageBytes != cache.storageBytes || info.st_size - sizeof(header) != header.storageBytes)
+        {
+            std::cerr << "Checkpoint " << path << " is truncated or corrupt. Exiting.\n";
+            status = 1;
+        }
+    }
+    if (status == 0)
+    {
+        // the stored arrays are exactly the layout cacheSetUp produced
+        std::memcpy(cache.storage.get(), bytes + sizeof(header), cache.storageBytes);
+        cache.accessClock = header.accessClock;
+        cache.randomState = header.randomState;
+        cache.loadCount = header.counters[0];
+        cache.storeCount = header.counters[1];
+        cache.loadHits = header.counters[2];
+        cache.loadMisses = header.counters[3];
+        cache.storeHits = header.counters[4];
+        cache.storeMisses = header.counters[5];
+        cache.totalCycles = header.counters[6];
+        cache.writeBacks = header.counters[7];
+        cache.backInvalidations = header.counters[8];
+    }
+    munmap(map, info.st_size);
+    return status;
+}
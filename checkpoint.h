@@ -0,0 +1,66 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+
+#include "cache_simulator.h"
+
+// CACHE CHECKPOINTS
+//
+// A checkpoint is a CheckpointHeader followed by a verbatim copy of the
+// cache's storage allocation (tags, timestamps, valid and dirty masks and
+// order lists, see Cache), so saving and restoring are a single write and a
+// single copy out of a memory-mapped file. The header records the geometry and
+// policies the contents belong to, the replacement clock and generator, and
+// the statistics.
+// Outstanding misses and buffered writes are not saved; a checkpoint is taken
+// after they have drained.
+
+static const char CHECKPOINT_MAGIC[8] = {'C', 'S', 'I', 'M', 'C', 'K', 'P', '\0'};
+static const uint32_t CHECKPOINT_VERSION = 2;
+
+/**
+ * Struct representing the fixed header at the start of a checkpoint.
+ */
+struct CheckpointHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t wideTags; // 1 if the tags are 64-bit
+    int32_t numSets;
+    int32_t numBlocks;
+    int32_t numBytes;
+    uint8_t missPolicy; // MissPolicy, WritePolicy and EvictionPolicy in enum order
+    uint8_t writePolicy;
+    uint8_t evictionPolicy;
+    uint8_t reserved;
+    uint32_t accessClock;
+    uint32_t padding;
+    uint64_t randomState; // Random and BRRIP generator state
+    uint64_t storageBytes;
+    uint64_t counters[9]; // loads, stores, load hits/misses, store hits/misses, cycles, write-backs, back-invalidations
+};
+
+/**
+ * Writes a cache's contents and statistics to a checkpoint file.
+ *
+ * @param cache The cache to save, with no outstanding timing events.
+ * @param path Path of the checkpoint file.
+ *
+ * @return int 0 for success, 1 if the file could not be written.
+ */
+int checkpointSave(const Cache &cache, const char *path);
+
+/**
+ * Restores a cache's contents and statistics from a checkpoint file.
+ * The cache must already be set up with the geometry and policies the
+ * checkpoint was taken with.
+ *
+ * @param cache Reference to the set-up Cache.
+ * @param path Path of the checkpoint file.
+ *
+ * @return int 0 for success, 1 for a missing, corrupt or mismatched checkpoint.
+ */
+int checkpointRestore(Cache &cache, const char *path);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,246 @@
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+#include "hierarchy.h"
+
+int parseLevel(const std::string &spec, Cache &cache)
+{
+    std::vector<std::string> fields;
+    std::stringstream stream(spec);
+    std::string field;
+    while (std::getline(stream, field, ':'))
+    {
+        fields.push_back(field);
+    }
+    if (fields.size() != 6 && fields.size() != 7)
+    {
+        std::cerr << "Invalid cache level " << spec << ", expected sets:blocks:bytes:miss:write:eviction[:inclusion]. Exiting.\n";
+        return 1;
+    }
+
+    int numSets = std::atoi(fields[0].c_str());
+    int numBlocks = std::atoi(fields[1].c_str());
+    int numBytes = std::atoi(fields[2].c_str());
+    if (validateArguments(numSets, numBlocks, numBytes, fields[3], fields[4], fields[5]) == 1)
+    {
+        return 1;
+    }
+
+    InclusionPolicy inclusion = InclusionPolicy::NINE;
+    if (fields.size() == 7)
+    {
+        if (fields[6] == "inclusive")
+        {
+            inclusion = InclusionPolicy::Inclusive;
+        }
+        else if (fields[6] == "exclusive")
+        {
+            inclusion = InclusionPolicy::Exclusive;
+        }
+        else if (fields[6] != "nine")
+        {
+            std::cerr << "Invalid input, not inclusive, exclusive or nine. Exiting.\n";
+            return 1;
+        }
+    }
+
+    cacheSetUp(cache, numSets, numBlocks, numBytes, fields[3], fields[4], fields[5]);
+    cache.inclusion = inclusion;
+    return 0;
+}
+
+int hierarchySetUp(std::vector<Cache> &levels)
+{
+    if (levels.empty())
+    {
+        std::cerr << "Invalid input, no cache levels. Exiting.\n";
+        return 1;
+    }
+    if (levels[0].inclusion != InclusionPolicy::NINE)
+    {
+        std::cerr << "Invalid input, the first level has no level above it to include or exclude. Exiting.\n";
+        return 1;
+    }
+
+    for (size_t i = 1; i < levels.size(); i++)
+    {
+        Cache &upper = levels[i - 1];
+        Cache &lower = levels[i];
+        if (lower.numBytes < upper.numBytes)
+        {
+            std::cerr << "Invalid input, block size shrinks from L" << i << " to L" << i + 1 << ". Exiting.\n";
+            return 1;
+        }
+        if (lower.inclusion == InclusionPolicy::Exclusive)
+        {
+            if (lower.numBytes != upper.numBytes)
+            {
+                std::cerr << "Invalid input, exclusive L" << i + 1 << " needs the block size of L" << i << ". Exiting.\n";
+                return 1;
+            }
+            if (upper.missPolicy != MissPolicy::WriteAllocate || upper.writePolicy != WritePolicy::WriteBack)
+            {
+                std::cerr << "Invalid input, the level above exclusive L" << i + 1 << " must be write-allocate and write-back. Exiting.\n";
+                return 1;
+            }
+        }
+        upper.nextLevel = &lower;
+        lower.prevLevel = &upper;
+    }
+    return 0;
+}
+
+// looks a block up in an exclusive level on behalf of the level above, moving it up on a hit
+static bool exclusiveFetch(Cache &level, uint64_t address)
+{
+    int index = calculateIndex(address, level);
+    uint64_t tag = calculateTag(address, level);
+    level.loadCount++;
+    int way = findBlock(tag, index, level);
+    if (way >= 0)
+    {
+        level.loadHits++;
+        level.totalCycles += level.timing.hitLatency;
+        bool dirty = level.isDirty(index, way);
+        cacheInvalidate(level, index, way); // the block now lives in the level above only
+        return dirty;
+    }
+
+    // missing blocks pass straight through to the level above without being kept here
+    level.loadMisses++;
+    if (level.nextLevel)
+    {
+        return fetchFromNextLevel(level, index, tag);
+    }
+    chargeFill(level, memoryCycles(level.timing, level.numBytes), address); // memory
+    return false;
+}
+
+bool fetchFromNextLevel(Cache &cache, int index, uint64_t tag)
+{
+    Cache &next = *cache.nextLevel;
+    uint64_t address = blockAddress(cache, index, tag);
+    uint64_t before = next.totalCycles;
+    bool dirty = false;
+    if (next.inclusion == InclusionPolicy::Exclusive)
+    {
+        dirty = exclusiveFetch(next, address);
+    }
+    else
+    {
+        next.simulate(next, 'l', address);
+    }
+    // the level below's cycles on this request are the miss latency seen here
+    chargeFill(cache, next.totalCycles - before, address);
+    return dirty;
+}
+
+void writeToNextLevel(Cache &cache, int index, uint64_t tag)
+{
+    Cache &next = *cache.nextLevel;
+    uint64_t before = next.totalCycles;
+    uint64_t address = blockAddress(cache, index, tag);
+    next.simulate(next, 's', address);
+    chargeWrite(cache, next.totalCycles - before, address);
+}
+
+// drops every copy of a lower-level block from one level above it, returning whether any was dirty
+static bool backInvalidate(Cache &upper, uint64_t address, int numBytes)
+{
+    bool dirty = false;
+    // block sizes never shrink down the hierarchy, so the block covers whole upper blocks
+    for (int offset = 0; offset < numBytes; offset += upper.numBytes)
+    {
+        int index = calculateIndex(address + offset, upper);
+        int way = findBlock(calculateTag(address + offset, upper), index, upper);
+        if (way >= 0)
+        {
+            dirty = dirty || upper.isDirty(index, way);
+            cacheInvalidate(upper, index, way);
+            upper.backInvalidations++;
+        }
+    }
+    return dirty;
+}
+
+void evictToNextLevel(Cache &cache, int index, int way)
+{
+    uint64_t address = blockAddress(cache, index, cache.tagAt(cache.slot(index, way)));
+    bool dirty = cache.isDirty(index, way);
+    if (cache.inclusion == InclusionPolicy::Inclusive)
+    {
+        for (Cache *upper = cache.prevLevel; upper; upper = upper->prevLevel)
+        {
+            dirty = backInvalidate(*upper, address, cache.numBytes) || dirty;
+        }
+    }
+    cacheInvalidate(cache, index, way);
+    if (dirty)
+    {
+        cache.writeBacks++;
+    }
+
+    Cache *next = cache.nextLevel;
+    if (next && next->inclusion == InclusionPolicy::Exclusive)
+    {
+        // an exclusive level is filled by evictions, clean or dirty
+        uint64_t before = next->totalCycles;
+        int nextIndex = calculateIndex(address, *next);
+        uint64_t nextTag = calculateTag(address, *next);
+        int found = findBlock(nextTag, nextIndex, *next);
+        if (found < 0)
+        {
+            cacheInsert(*next, nextIndex, nextTag, dirty);
+        }
+        else if (dirty)
+        {
+            next->setDirty(nextIndex, found, true);
+        }
+        chargeWrite(cache, next->totalCycles - before, address);
+        return;
+    }
+    if (!dirty)
+    {
+        return;
+    }
+    if (next)
+    {
+        uint64_t before = next->totalCycles;
+        next->simulate(*next, 's', address);
+        chargeWrite(cache, next->totalCycles - before, address);
+    }
+    else
+    {
+        chargeWrite(cache, memoryCycles(cache.timing, cache.numBytes), address); // store to memory
+    }
+}
+
+void runHierarchy(std::vector<Cache> &levels, TraceReader &reader)
+{
+    Cache &first = levels.front();
+    TraceBatch batch;
+    while (traceNextBatch(reader, batch) > 0)
+    {
+        cacheSimulateBatch(first, batch.loadStore.data(), batch.addresses.data(), batch.count);
+    }
+    for (Cache &level : levels)
+    {
+        timingDrain(level);
+    }
+}
+
+void displayHierarchy(std::vector<Cache> &levels)
+{
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        if (i > 0)
+        {
+            std::cout << std::endl;
+        }
+        std::cout << "L" << i + 1 << ":" << std::endl;
+        displayStatistics(levels[i]);
+        std::cout << "Write-backs: " << levels[i].writeBacks << std::endl;
+        std::cout << "Back-invalidations: " << levels[i].backInvalidations << std::endl;
+    }
+}
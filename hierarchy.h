@@ -0,0 +1,98 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+#include "trace_reader.h"
+
+// MULTI-LEVEL CACHE HIERARCHY
+//
+// Levels are ordinary caches linked through Cache::nextLevel/prevLevel. A
+// level's misses become loads of the missing block at the next level, its
+// write-through stores and dirty write-backs become stores there, and only the
+// last level pays the memory penalty. The cycles a lower level spends on
+// a request are also charged to the level that made it, so the first level's
+// totalCycles is the cost of the whole trace.
+//
+// Each level below the first states how it relates to the level above:
+// - nine (default): fills pass through every level and each level evicts on its own;
+// - inclusive: evicting a block also invalidates its copies in every level above,
+//   whose dirty data is written back with it;
+// - exclusive: the level only receives blocks evicted from the level above, and
+//   hands a block back (removing its own copy) when the level above misses on it.
+
+/**
+ * Parses a level specification "sets:blocks:bytes:miss:write:eviction[:inclusion]"
+ * (the six csim arguments, optionally followed by nine, inclusive or exclusive)
+ * and sets up the level's cache.
+ *
+ * @param spec The level specification.
+ * @param cache Reference to the Cache to set up.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int parseLevel(const std::string &spec, Cache &cache);
+
+/**
+ * Links already set-up caches into a hierarchy, first level first.
+ * Block sizes may not shrink from one level to the next, an exclusive level
+ * needs the same block size as the level above it, and the level above an
+ * exclusive level must be write-allocate and write-back so every block it
+ * drops reaches the exclusive level. The vector must not be resized afterwards.
+ *
+ * @param levels Reference to the levels, first level first.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int hierarchySetUp(std::vector<Cache> &levels);
+
+/**
+ * Fetches a block missing at a level from the level below it.
+ * Called by the simulator core only for caches with a nextLevel.
+ *
+ * @param cache The level that missed.
+ * @param index The index of the missing block's set.
+ * @param tag The tag of the missing block.
+ *
+ * @return bool true if the block arrives dirty (handed back by an exclusive level).
+ */
+bool fetchFromNextLevel(Cache &cache, int index, uint64_t tag);
+
+/**
+ * Forwards a write-through store, or a store that does not allocate, to the level below.
+ *
+ * @param cache The level writing through.
+ * @param index The index of the stored block's set.
+ * @param tag The tag of the stored block.
+ */
+void writeToNextLevel(Cache &cache, int index, uint64_t tag);
+
+/**
+ * Evicts a block from a linked level: back-invalidates the levels above when
+ * the level is inclusive, then moves the block to an exclusive level below or
+ * writes it back if it is dirty. The way is left invalid.
+ *
+ * @param cache The level evicting the block.
+ * @param index The index of the victim's set.
+ * @param way The victim's way.
+ */
+void evictToNextLevel(Cache &cache, int index, int way);
+
+/**
+ * Simulates every record of a trace against the first level of a hierarchy.
+ *
+ * @param levels Reference to the linked levels.
+ * @param reader Reference to an open TraceReader.
+ */
+void runHierarchy(std::vector<Cache> &levels, TraceReader &reader);
+
+/**
+ * Displays the statistics of every level, first level first.
+ *
+ * @param levels Reference to the simulated levels.
+ */
+void displayHierarchy(std::vector<Cache> &levels);
+
+#endif // HIERARCHY_H
@@ -0,0 +1,317 @@
+#include <iostream>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "hotspot.h"
+
+// page table slots before it first grows
+static const size_t HOTSPOT_INITIAL_PAGES = 1 << 12;
+// misses ahead whose page slots are prefetched; a miss's slot is a likely host cache miss
+static const size_t HOTSPOT_PREFETCH_DISTANCE = 16;
+
+static inline size_t hashPage(uint64_t page)
+{
+    page *= 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(page ^ (page >> 29));
+}
+
+// an address in hex (0x...) or decimal
+static bool parseAddress(const std::string &text, uint64_t &address)
+{
+    char *end;
+    address = std::strtoull(text.c_str(), &end, 0);
+    return !text.empty() && text[0] != '-' && *end == '\0';
+}
+
+int readRegionMap(const char *path, HotSpots &hotSpots)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Could not open region map " << path << ". Exiting.\n";
+        return 1;
+    }
+
+    std::vector<Region> regions;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::stringstream stream(line);
+        Region region;
+        std::string start;
+        std::string end;
+        if (!(stream >> region.name) || region.name[0] == '#')
+        {
+            continue;
+        }
+        std::string extra;
+        if (!(stream >> start >> end) || (stream >> extra) || !parseAddress(start, region.start) ||
+            !parseAddress(end, region.end) || region.end <= region.start)
+        {
+            std::cerr << "Invalid region line \"" << line << "\", expected a name, a start and a larger end. Exiting.\n";
+            return 1;
+        }
+        regions.push_back(region);
+    }
+    if (regions.empty())
+    {
+        std::cerr << "Region map " << path << " has no regions. Exiting.\n";
+        return 1;
+    }
+
+    std::sort(regions.begin(), regions.end(), [](const Region &a, const Region &b)
+              { return a.start < b.start; });
+    for (size_t i = 1; i < regions.size(); i++)
+    {
+        if (regions[i].start < regions[i - 1].end)
+        {
+            std::cerr << "Regions " << regions[i - 1].name << " and " << regions[i].name << " overlap. Exiting.\n";
+            return 1;
+        }
+    }
+    hotSpots.regions.swap(regions);
+    return 0;
+}
+
+// doubles the page table
+static void growPages(HotSpots &hotSpots)
+{
+    std::vector<PageSlot> pages(hotSpots.pages.size() * 2);
+    size_t mask = pages.size() - 1;
+    for (const PageSlot &entry : hotSpots.pages)
+    {
+        if (entry.key != 0)
+        {
+            size_t slot = hashPage(entry.key - 1) & mask;
+            while (pages[slot].key != 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            pages[slot] = entry;
+        }
+    }
+    hotSpots.pages.swap(pages);
+}
+
+// counts a miss against the page or region of its address
+static void countMiss(HotSpots &hotSpots, uint64_t address)
+{
+    if (!hotSpots.regions.empty())
+    {
+        // the last region starting at or below the address
+        auto next = std::upper_bound(hotSpots.regions.begin(), hotSpots.regions.end(), address,
+                                     [](uint64_t value, const Region &region)
+                                     { return value < region.start; });
+        if (next != hotSpots.regions.begin() && address < (next - 1)->end)
+        {
+            (next - 1)->misses++;
+        }
+        else
+        {
+            hotSpots.otherMisses++;
+        }
+        return;
+    }
+
+    if (2 * (hotSpots.pageCount + 1) > hotSpots.pages.size())
+    {
+        growPages(hotSpots);
+    }
+    uint64_t page = address >> HOTSPOT_PAGE_BITS;
+    uint64_t key = page + 1; // pages are shifted addresses, so this never wraps
+    size_t mask = hotSpots.pages.size() - 1;
+    size_t slot = hashPage(page) & mask;
+    while (hotSpots.pages[slot].key != key && hotSpots.pages[slot].key != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    if (hotSpots.pages[slot].key == 0)
+    {
+        hotSpots.pages[slot].key = key;
+        hotSpots.pageCount++;
+    }
+    hotSpots.pages[slot].misses++;
+}
+
+// the access path of a cache with histograms: the cache's own access, then the counts
+static void hotSpotAccess(Cache &cache, char loadStore, uint64_t address)
+{
+    HotSpots &hotSpots = *cache.hotSpots;
+    int index = calculateIndex(address, cache);
+    bool full = cacheSetFull(cache, index);
+    uint64_t misses = cache.loadMisses + cache.storeMisses;
+    hotSpots.inner(cache, loadStore, address);
+
+    SetCounters &set = hotSpots.sets[index];
+    if (cache.loadMisses + cache.storeMisses == misses)
+    {
+        set.hits++;
+        return;
+    }
+    set.misses++;
+    // a miss in a full set evicts, unless it is a store that does not allocate
+    set.evictions += full && (loadStore == 'l' || cache.missPolicy == MissPolicy::WriteAllocate);
+    countMiss(hotSpots, address);
+}
+
+static void hotSpotBatch(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count)
+{
+    HotSpots &hotSpots = *cache.hotSpots;
+    if (!hotSpots.batched)
+    {
+        // the set of an access ahead and, without a region map, its page slot in case it misses
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i + BATCH_PREFETCH_DISTANCE < count)
+            {
+                uint64_t address = addresses[i + BATCH_PREFETCH_DISTANCE];
+                cachePrefetchSet(cache, calculateIndex(address, cache));
+                if (!hotSpots.pages.empty())
+                {
+                    __builtin_prefetch(&hotSpots.pages[hashPage(address >> HOTSPOT_PAGE_BITS) & (hotSpots.pages.size() - 1)], 1);
+                }
+            }
+            hotSpotAccess(cache, loadStore[i], addresses[i]);
+        }
+        return;
+    }
+
+    // the cache's own batched path, then the counts from each access's outcome; only the
+    // page slots of upcoming misses are prefetched
+    AccessOutcome outcomes[BATCH_DECODE_SIZE];
+    for (size_t start = 0; start < count; start += BATCH_DECODE_SIZE)
+    {
+        size_t n = std::min(count - start, BATCH_DECODE_SIZE);
+        const uint64_t *chunk = addresses + start;
+        cacheSimulateOutcomes(cache, loadStore + start, chunk, n, outcomes);
+        for (size_t i = 0; i < n; i++)
+        {
+            if (i + HOTSPOT_PREFETCH_DISTANCE < n && outcomes[i + HOTSPOT_PREFETCH_DISTANCE] != AccessOutcome::Hit &&
+                !hotSpots.pages.empty())
+            {
+                uint64_t address = chunk[i + HOTSPOT_PREFETCH_DISTANCE];
+                __builtin_prefetch(&hotSpots.pages[hashPage(address >> HOTSPOT_PAGE_BITS) & (hotSpots.pages.size() - 1)], 1);
+            }
+            SetCounters &set = hotSpots.sets[calculateIndex(chunk[i], cache)];
+            if (outcomes[i] == AccessOutcome::Hit)
+            {
+                set.hits++;
+                continue;
+            }
+            set.misses++;
+            set.evictions += outcomes[i] == AccessOutcome::Eviction;
+            countMiss(hotSpots, chunk[i]);
+        }
+    }
+}
+
+void hotSpotAttach(HotSpots &hotSpots, Cache &cache)
+{
+    hotSpots.sets.assign(cache.numSets, SetCounters());
+    hotSpots.pages.assign(hotSpots.regions.empty() ? HOTSPOT_INITIAL_PAGES : 0, PageSlot());
+    hotSpots.pageCount = 0;
+    hotSpotClearStatistics(hotSpots);
+    hotSpots.inner = cache.simulate;
+    hotSpots.batched = cache.simulate == selectAccessFunction(cache.missPolicy, cache.writePolicy, cache.evictionPolicy);
+    cache.hotSpots = &hotSpots;
+    cache.simulate = hotSpotAccess;
+    cache.simulateBatch = hotSpotBatch;
+}
+
+void hotSpotClearStatistics(HotSpots &hotSpots)
+{
+    std::fill(hotSpots.sets.begin(), hotSpots.sets.end(), SetCounters());
+    for (PageSlot &page : hotSpots.pages)
+    {
+        page.misses = 0; // pages seen keep their slots
+    }
+    for (Region &region : hotSpots.regions)
+    {
+        region.misses = 0;
+    }
+    hotSpots.otherMisses = 0;
+}
+
+static std::string hexAddress(uint64_t address)
+{
+    std::stringstream text;
+    text << "0x" << std::hex << address;
+    return text.str();
+}
+
+// prints the sets with any access, then the pages with any miss, most first, each formatted into
+// one buffer: a large cache or a sparse trace has hundreds of thousands of them
+static void displaySetsAndPages(const HotSpots &hotSpots, const char *setFormat, const char *pageFormat,
+                                const char *separator, const char *between)
+{
+    std::string text;
+    char line[128];
+    const char *next = "";
+    for (size_t index = 0; index < hotSpots.sets.size(); index++)
+    {
+        const SetCounters &set = hotSpots.sets[index];
+        if (set.hits || set.misses)
+        {
+            text += next;
+            text.append(line, std::snprintf(line, sizeof(line), setFormat, index, set.hits, set.misses, set.evictions));
+            next = separator;
+        }
+    }
+    text += between;
+
+    std::vector<PageSlot> pages;
+    for (const PageSlot &page : hotSpots.pages)
+    {
+        if (page.misses)
+        {
+            pages.push_back(page);
+        }
+    }
+    std::sort(pages.begin(), pages.end(), [](const PageSlot &a, const PageSlot &b)
+              { return a.misses != b.misses ? a.misses > b.misses : a.key < b.key; });
+    next = "";
+    for (const PageSlot &page : pages)
+    {
+        text += next;
+        text.append(line, std::snprintf(line, sizeof(line), pageFormat, (page.key - 1) << HOTSPOT_PAGE_BITS, page.misses));
+        next = separator;
+    }
+    std::cout << text;
+}
+
+void displayHotSpots(const HotSpots &hotSpots, bool csv)
+{
+    if (csv)
+    {
+        std::cout << "kind,id,hits,misses,evictions\n";
+        displaySetsAndPages(hotSpots, "set,%zu,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", "page,0x%" PRIx64 ",,%" PRIu64 ",\n", "", "");
+        for (const Region &region : hotSpots.regions)
+        {
+            std::cout << "region," << region.name << ",," << region.misses << ",\n";
+        }
+        if (!hotSpots.regions.empty())
+        {
+            std::cout << "region,other,," << hotSpots.otherMisses << ",\n";
+        }
+        return;
+    }
+
+    std::cout << "{\"sets\":[";
+    displaySetsAndPages(hotSpots, "{\"set\":%zu,\"hits\":%" PRIu64 ",\"misses\":%" PRIu64 ",\"evictions\":%" PRIu64 "}",
+                        "{\"page\":\"0x%" PRIx64 "\",\"misses\":%" PRIu64 "}", ",",
+                        hotSpots.regions.empty() ? "],\"pages\":[" : "],\"regions\":[");
+    for (const Region &region : hotSpots.regions)
+    {
+        std::cout << "{\"region\":\"" << region.name << "\",\"start\":\"" << hexAddress(region.start)
+                  << "\",\"end\":\"" << hexAddress(region.end) << "\",\"misses\":" << region.misses << "},";
+    }
+    if (!hotSpots.regions.empty())
+    {
+        std::cout << "{\"region\":\"other\",\"misses\":" << hotSpots.otherMisses << '}';
+    }
+    std::cout << "]}\n";
+}
@@ -0,0 +1,116 @@
+#ifndef HOTSPOT_H
+#define HOTSPOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+
+// HOT-SPOT HISTOGRAMS
+//
+// Counts, for every set of a cache, its hits, misses and the evictions its
+// misses caused, and attributes each miss to the address region it falls in:
+// a 4 KB page, or a region of a user-provided map. Set counters are one flat
+// array indexed by set. Pages live in an open-addressing table that only
+// misses probe, and a region map is searched by binary search, also only on a
+// miss, so a hit costs an increment. Attaching swaps the cache's access
+// functions like a prefetcher or miss classifier does, wrapping whichever
+// path is attached when it is. Over the core's own path, batches keep the
+// core's decoding and set prefetching: cacheSimulateOutcomes reports what
+// each access did, and the counts are taken from that.
+
+// pages are 1 << HOTSPOT_PAGE_BITS bytes
+static const int HOTSPOT_PAGE_BITS = 12;
+
+/**
+ * Struct representing the counters of one set.
+ */
+struct SetCounters
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0; // Valid blocks a miss in the set replaced
+};
+
+/**
+ * Struct representing one page in the page table.
+ */
+struct PageSlot
+{
+    uint64_t key = 0; // Page number + 1 (0: empty)
+    uint64_t misses = 0;
+};
+
+/**
+ * Struct representing one region of a user-provided map.
+ */
+struct Region
+{
+    std::string name;
+    uint64_t start = 0;
+    uint64_t end = 0; // First address past the region
+    uint64_t misses = 0;
+};
+
+/**
+ * Struct representing the hot-spot histograms of one cache.
+ */
+struct HotSpots
+{
+    std::vector<SetCounters> sets; // One per set
+
+    // PAGE TABLE (no region map): linear probing, at most half full
+    std::vector<PageSlot> pages;
+    size_t pageCount = 0;
+
+    // REGION MAP: sorted by start, not overlapping
+    std::vector<Region> regions;
+    uint64_t otherMisses = 0; // Misses outside every region
+
+    AccessFunction inner = nullptr; // The cache's access path before attaching
+    bool batched = false;           // Indicates if that path is the core's own, so batches run through cacheSimulateOutcomes
+};
+
+/**
+ * Reads a region map: one region per line, "<name> <start> <end>", the
+ * addresses in hex (0x...) or decimal and end exclusive. Blank lines and
+ * lines starting with # are skipped. Regions may come in any order but must
+ * not overlap.
+ *
+ * @param path The path of the map file.
+ * @param hotSpots Reference to the HotSpots receiving the regions.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int readRegionMap(const char *path, HotSpots &hotSpots);
+
+/**
+ * Attaches hot-spot histograms to a cache, clearing them, so that every later
+ * cacheSimulator and cacheSimulateBatch call is counted. Misses go to pages
+ * unless a region map was read first. Attach after any prefetcher.
+ *
+ * @param hotSpots Reference to the HotSpots, which must outlive the cache's use.
+ * @param cache Reference to the Cache, already set up by cacheSetUp.
+ */
+void hotSpotAttach(HotSpots &hotSpots, Cache &cache);
+
+/**
+ * Clears the histograms' counts.
+ *
+ * @param hotSpots Reference to the HotSpots.
+ */
+void hotSpotClearStatistics(HotSpots &hotSpots);
+
+/**
+ * Displays the histograms after displayStatistics, as one JSON object or as
+ * CSV rows "kind,id,hits,misses,evictions": sets with any access by index,
+ * then pages by misses, most first, or the regions in address order and the
+ * misses outside them. Pages and regions leave hits and evictions empty.
+ *
+ * @param hotSpots Reference to the HotSpots.
+ * @param csv CSV rows instead of JSON.
+ */
+void displayHotSpots(const HotSpots &hotSpots, bool csv);
+
+#endif // HOTSPOT_H
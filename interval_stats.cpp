@@ -0,0 +1,165 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+#include "interval_stats.h"
+
+static IntervalSnapshot readCounters(const Cache &cache)
+{
+    IntervalSnapshot snapshot;
+    snapshot.loads = cache.loadCount;
+    snapshot.stores = cache.storeCount;
+    snapshot.loadHits = cache.loadHits;
+    snapshot.loadMisses = cache.loadMisses;
+    snapshot.storeHits = cache.storeHits;
+    snapshot.storeMisses = cache.storeMisses;
+    snapshot.cycles = cache.totalCycles;
+    return snapshot;
+}
+
+// writer side of the sequence lock, only ever called by the simulating thread
+static void publish(IntervalReporter &reporter, const Cache &cache)
+{
+    IntervalSnapshot snapshot = readCounters(cache);
+    const uint64_t fields[7] = {snapshot.loads, snapshot.stores, snapshot.loadHits, snapshot.loadMisses,
+                                snapshot.storeHits, snapshot.storeMisses, snapshot.cycles};
+    uint64_t sequence = reporter.sequence.load(std::memory_order_relaxed);
+    reporter.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < 7; i++)
+    {
+        reporter.published[i].store(fields[i], std::memory_order_relaxed);
+    }
+    reporter.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// reader side: retries while a write is in progress or happened during the read
+static IntervalSnapshot readPublished(IntervalReporter &reporter)
+{
+    uint64_t fields[7];
+    uint64_t before;
+    uint64_t after;
+    do
+    {
+        before = reporter.sequence.load(std::memory_order_acquire);
+        for (int i = 0; i < 7; i++)
+        {
+            fields[i] = reporter.published[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = reporter.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    IntervalSnapshot snapshot;
+    snapshot.loads = fields[0];
+    snapshot.stores = fields[1];
+    snapshot.loadHits = fields[2];
+    snapshot.loadMisses = fields[3];
+    snapshot.storeHits = fields[4];
+    snapshot.storeMisses = fields[5];
+    snapshot.cycles = fields[6];
+    return snapshot;
+}
+
+// prints the counters gained since the previous interval
+static void emit(IntervalReporter &reporter, const IntervalSnapshot &now)
+{
+    const IntervalSnapshot &last = reporter.last;
+    uint64_t loads = now.loads - last.loads;
+    uint64_t stores = now.stores - last.stores;
+    uint64_t loadHits = now.loadHits - last.loadHits;
+    uint64_t storeHits = now.storeHits - last.storeHits;
+    uint64_t accesses = loads + stores;
+    double hitRate = accesses ? static_cast<double>(loadHits + storeHits) / accesses : 0.0;
+    reporter.intervals++;
+
+    if (reporter.csv)
+    {
+        std::cout << reporter.intervals << ',' << accesses << ',' << loads << ',' << stores << ','
+                  << loadHits << ',' << now.loadMisses - last.loadMisses << ','
+                  << storeHits << ',' << now.storeMisses - last.storeMisses << ','
+                  << now.cycles - last.cycles << ',' << hitRate << ',' << now.loads + now.stores << '\n';
+    }
+    else
+    {
+        std::cout << "{\"interval\":" << reporter.intervals << ",\"accesses\":" << accesses
+                  << ",\"loads\":" << loads << ",\"stores\":" << stores
+                  << ",\"load_hits\":" << loadHits << ",\"load_misses\":" << now.loadMisses - last.loadMisses
+                  << ",\"store_hits\":" << storeHits << ",\"store_misses\":" << now.storeMisses - last.storeMisses
+                  << ",\"cycles\":" << now.cycles - last.cycles << ",\"hit_rate\":" << hitRate
+                  << ",\"total_accesses\":" << now.loads + now.stores << "}\n";
+    }
+    std::cout.flush(); // readers of a live run want each line as soon as it exists
+    reporter.last = now;
+}
+
+static void reporterLoop(IntervalReporter &reporter)
+{
+    auto period = std::chrono::duration<double>(reporter.everySeconds);
+    auto next = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    std::unique_lock<std::mutex> guard(reporter.lock);
+    while (!reporter.wake.wait_until(guard, next, [&]()
+                                     { return reporter.stopping; }))
+    {
+        emit(reporter, readPublished(reporter));
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    }
+}
+
+void intervalStart(IntervalReporter &reporter, const Cache &cache)
+{
+    if (reporter.csv)
+    {
+        std::cout << "interval,accesses,loads,stores,load_hits,load_misses,store_hits,store_misses,cycles,hit_rate,total_accesses\n";
+    }
+    // intervals count from the counters the cache starts with, such as those restored from a checkpoint
+    reporter.last = readCounters(cache);
+    reporter.nextBoundary = reporter.last.loads + reporter.last.stores + reporter.everyAccesses;
+    publish(reporter, cache);
+    if (reporter.everySeconds > 0)
+    {
+        reporter.thread = std::thread(reporterLoop, std::ref(reporter));
+    }
+}
+
+void intervalSimulate(IntervalReporter &reporter, Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count)
+{
+    if (reporter.everyAccesses == 0)
+    {
+        cacheSimulateBatch(cache, loadStore, addresses, count);
+        publish(reporter, cache);
+        return;
+    }
+    // split the run at every interval boundary it crosses
+    size_t done = 0;
+    while (done < count)
+    {
+        uint64_t simulated = cache.loadCount + cache.storeCount;
+        size_t piece = static_cast<size_t>(std::min<uint64_t>(count - done, reporter.nextBoundary - simulated));
+        cacheSimulateBatch(cache, loadStore + done, addresses + done, piece);
+        done += piece;
+        if (simulated + piece == reporter.nextBoundary)
+        {
+            emit(reporter, readCounters(cache));
+            reporter.nextBoundary += reporter.everyAccesses;
+        }
+    }
+}
+
+void intervalFinish(IntervalReporter &reporter, Cache &cache)
+{
+    if (reporter.thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(reporter.lock);
+            reporter.stopping = true;
+        }
+        reporter.wake.notify_one();
+        reporter.thread.join();
+    }
+    IntervalSnapshot now = readCounters(cache);
+    if (now.loads + now.stores > reporter.last.loads + reporter.last.stores)
+    {
+        emit(reporter, now);
+    }
+}
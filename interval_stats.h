@@ -0,0 +1,91 @@
+#ifndef INTERVAL_STATS_H
+#define INTERVAL_STATS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "cache_simulator.h"
+
+// STREAMING INTERVAL STATISTICS
+//
+// While a long or live trace is simulated, the counters gained in each interval
+// are printed as one JSON object or CSV row per line. Intervals are counted in
+// accesses, and are then emitted by the simulating thread at exact access
+// boundaries, or in seconds of wall time, and are then emitted by a reporter
+// thread from a snapshot the simulating thread publishes after every batch.
+// The snapshot is a sequence lock, so neither side ever waits for the other.
+
+/**
+ * Struct representing the counters of a cache at one point of a run.
+ */
+struct IntervalSnapshot
+{
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+    uint64_t loadHits = 0;
+    uint64_t loadMisses = 0;
+    uint64_t storeHits = 0;
+    uint64_t storeMisses = 0;
+    uint64_t cycles = 0;
+};
+
+/**
+ * Struct representing the interval output of one run.
+ */
+struct IntervalReporter
+{
+    uint64_t everyAccesses = 0; // Interval length in accesses (0: not counted in accesses)
+    double everySeconds = 0;    // Interval length in seconds (0: not timed)
+    bool csv = false;           // CSV rows instead of JSON lines
+    uint64_t nextBoundary = 0;  // Access count that closes the current counted interval
+
+    // SNAPSHOT PUBLISHED BY THE SIMULATING THREAD (sequence lock: odd while being written)
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> published[7];
+
+    // EMITTER STATE (owned by whichever thread prints)
+    IntervalSnapshot last; // Counters at the end of the previous interval
+    uint64_t intervals = 0;
+
+    // REPORTER THREAD (timed intervals only)
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+/**
+ * Starts interval output: prints the CSV header, and starts the reporter
+ * thread for timed intervals. Exactly one of everyAccesses and everySeconds
+ * must be set. The first interval starts from the cache's current counters,
+ * so one restored from a checkpoint reports only the accesses after it.
+ *
+ * @param reporter Reference to the configured IntervalReporter.
+ * @param cache Reference to the Cache about to be simulated.
+ */
+void intervalStart(IntervalReporter &reporter, const Cache &cache);
+
+/**
+ * Simulates a run of accesses, closing every counted interval inside it at
+ * its exact access and publishing the counters for timed intervals.
+ *
+ * @param reporter Reference to the started IntervalReporter.
+ * @param cache Reference to the Cache being simulated.
+ * @param loadStore The operation of each access.
+ * @param addresses The address of each access.
+ * @param count The number of accesses.
+ */
+void intervalSimulate(IntervalReporter &reporter, Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count);
+
+/**
+ * Stops the reporter thread and prints the last, partial interval if it has any accesses.
+ *
+ * @param reporter Reference to the started IntervalReporter.
+ * @param cache Reference to the simulated Cache.
+ */
+void intervalFinish(IntervalReporter &reporter, Cache &cache);
+
+#endif // INTERVAL_STATS_H
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "libcsim.h"
+#include "cache_simulator.h"
+#include "timing.h"
+
+struct csim_cache
+{
+    Cache cache;
+};
+
+csim_cache *csim_create(int sets, int blocks, int bytes, const char *miss, const char *write, const char *eviction)
+{
+    if (miss == nullptr || write == nullptr || eviction == nullptr ||
+        validateArguments(sets, blocks, bytes, miss, write, eviction) == 1)
+    {
+        return nullptr;
+    }
+    // exceptions must not cross the C boundary
+    try
+    {
+        std::unique_ptr<csim_cache> handle(new csim_cache);
+        cacheSetUp(handle->cache, sets, blocks, bytes, miss, write, eviction);
+        return handle.release();
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Could not allocate the cache.\n";
+        return nullptr;
+    }
+}
+
+int csim_load_timing(csim_cache *cache, const char *path)
+{
+    try
+    {
+        std::vector<TimingModel> timing(1);
+        if (readTimingFile(path, timing) == 1)
+        {
+            return 1;
+        }
+        timingSetUp(cache->cache, timing[0]);
+        cacheReset(cache->cache);
+        return 0;
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Could not load the timing model.\n";
+        return 1;
+    }
+}
+
+// widening the tags for the first address that needs 64 bits, and renumbering the stamps before
+// the access clock wraps, allocate
+int csim_access(csim_cache *cache, char load_store, uint64_t address)
+{
+    try
+    {
+        cacheSimulator(cache->cache, load_store, address);
+        return 0;
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Could not simulate the access.\n";
+        return 1;
+    }
+}
+
+int csim_access_batch(csim_cache *cache, const char *load_store, const uint64_t *addresses, size_t count)
+{
+    try
+    {
+        cacheSimulateBatch(cache->cache, load_store, addresses, count);
+        return 0;
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Could not simulate the accesses.\n";
+        return 1;
+    }
+}
+
+void csim_get_stats(csim_cache *cache, csim_stats *stats)
+{
+    Cache &c = cache->cache;
+    timingDrain(c);
+    stats->loads = c.loadCount;
+    stats->stores = c.storeCount;
+    stats->load_hits = c.loadHits;
+    stats->load_misses = c.loadMisses;
+    stats->store_hits = c.storeHits;
+    stats->store_misses = c.storeMisses;
+    stats->cycles = c.totalCycles;
+    stats->write_backs = c.writeBacks;
+}
+
+int csim_reset(csim_cache *cache)
+{
+    try
+    {
+        cacheReset(cache->cache);
+        return 0;
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Could not reset the cache.\n";
+        return 1;
+    }
+}
+
+int csim_reconfigure(csim_cache *cache, int sets, int blocks, int bytes, const char *miss, const char *write, const char *eviction)
+{
+    if (miss == nullptr || write == nullptr || eviction == nullptr ||
+        validateArguments(sets, blocks, bytes, miss, write, eviction) == 1)
+    {
+        return 1;
+    }
+    // cacheSetUp allocates before it changes the cache, so a failure leaves it as it was
+    try
+    {
+        cacheSetUp(cache->cache, sets, blocks, bytes, miss, write, eviction);
+        cacheClearStatistics(cache->cache);
+        return 0;
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Could not allocate the cache.\n";
+        return 1;
+    }
+}
+
+void csim_destroy(csim_cache *cache)
+{
+    delete cache;
+}
@@ -0,0 +1,140 @@
+#ifndef LIBCSIM_H
+#define LIBCSIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// C INTERFACE TO THE SIMULATOR
+//
+// A stable C ABI over cache_simulator.h for tools that drive the simulator in
+// process (profilers, instrumentation, bindings from other languages) instead
+// of piping a text trace into csim. Link against libcsim.a or libcsim.so.
+// A csim_cache is not thread-safe, but different caches may be used from
+// different threads at the same time. No C++ exception ever leaves these
+// functions: every call that can fail, including running out of memory in
+// the middle of a run, reports it through its return value and prints the
+// reason to stderr.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Opaque handle to one simulated cache.
+ */
+typedef struct csim_cache csim_cache;
+
+/**
+ * Statistics of a simulated cache, the same counters csim prints.
+ */
+typedef struct csim_stats
+{
+    uint64_t loads;
+    uint64_t stores;
+    uint64_t load_hits;
+    uint64_t load_misses;
+    uint64_t store_hits;
+    uint64_t store_misses;
+    uint64_t cycles;
+    uint64_t write_backs;
+} csim_stats;
+
+/**
+ * Creates a cache from the six csim arguments.
+ *
+ * @param sets The number of sets (a power of 2).
+ * @param blocks The number of blocks per set (a power of 2).
+ * @param bytes The number of bytes per block (a power of 2, at least 4).
+ * @param miss "write-allocate" or "no-write-allocate".
+ * @param write "write-through" or "write-back".
+ * @param eviction "lru", "fifo", "plru", "srrip", "brrip", "random" or "lfu".
+ *
+ * @return The new cache, or NULL if the configuration is invalid (the reason is printed to stderr).
+ */
+csim_cache *csim_create(int sets, int blocks, int bytes, const char *miss, const char *write, const char *eviction);
+
+/**
+ * Applies a timing file (see the README) to a cache and resets it.
+ *
+ * @param cache The cache.
+ * @param path Path of the timing file.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int csim_load_timing(csim_cache *cache, const char *path);
+
+/**
+ * Simulates one access.
+ *
+ * @param cache The cache.
+ * @param load_store 'l' for a load, 's' for a store.
+ * @param address The address accessed.
+ *
+ * @return int 0 for success, 1 if memory ran out (the first address that
+ * needs 64-bit tags widens the cache's arrays).
+ */
+int csim_access(csim_cache *cache, char load_store, uint64_t address);
+
+/**
+ * Simulates a run of accesses through the batched path.
+ *
+ * @param cache The cache.
+ * @param load_store The operation of each access, 'l' or 's'.
+ * @param addresses The address of each access.
+ * @param count The number of accesses.
+ *
+ * @return int 0 for success, 1 if memory ran out partway. The accesses
+ * before the failing one have then been simulated, and the failing one may
+ * be partly counted.
+ */
+int csim_access_batch(csim_cache *cache, const char *load_store, const uint64_t *addresses, size_t count);
+
+/**
+ * Reads a cache's statistics, first waiting for its outstanding misses and writes.
+ *
+ * @param cache The cache.
+ * @param stats Receives the statistics.
+ */
+void csim_get_stats(csim_cache *cache, csim_stats *stats);
+
+/**
+ * Empties a cache and clears its statistics, keeping its configuration and timing.
+ *
+ * @param cache The cache.
+ *
+ * @return int 0 for success, 1 if memory ran out.
+ */
+int csim_reset(csim_cache *cache);
+
+/**
+ * Gives an existing cache another configuration, emptied and with its
+ * statistics cleared, keeping its timing. Its memory is reused when the new
+ * configuration fits in it, so a tool can cycle through many configurations
+ * with one cache.
+ *
+ * @param cache The cache.
+ * @param sets The number of sets (a power of 2).
+ * @param blocks The number of blocks per set (a power of 2).
+ * @param bytes The number of bytes per block (a power of 2, at least 4).
+ * @param miss "write-allocate" or "no-write-allocate".
+ * @param write "write-through" or "write-back".
+ * @param eviction "lru", "fifo", "plru", "srrip", "brrip", "random" or "lfu".
+ *
+ * @return int 0 for success, 1 if the configuration is invalid or cannot be
+ * allocated; the cache is then left as it was.
+ */
+int csim_reconfigure(csim_cache *cache, int sets, int blocks, int bytes, const char *miss, const char *write, const char *eviction);
+
+/**
+ * Frees a cache. NULL is ignored.
+ *
+ * @param cache The cache.
+ */
+void csim_destroy(csim_cache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIBCSIM_H
@@ -1,19 +1,541 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <algorithm>
 
 #include "cache_simulator.h"
+#include "trace_reader.h"
+#include "trace_binary.h"
+#include "sweep.h"
+#include "stack_distance.h"
+#include "hierarchy.h"
+#include "multicore.h"
+#include "streams.h"
+#include "interval_stats.h"
+#include "sampling.h"
+#include "checkpoint.h"
+#include "prefetch.h"
+#include "miss_classifier.h"
+#include "hotspot.h"
+#include "victim_cache.h"
+#include "synthetic.h"
 
 int main(int argc, char *argv[])
 {
+    // CONVERT MODE: ./csim convert <output file> [--delta] [--wide] [--cores] < tracefile
+    if (argc >= 2 && std::string(argv[1]) == "convert")
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Invalid input. Exiting.\n";
+            return 1;
+        }
+        uint32_t flags = 0;
+        for (int arg = 3; arg < argc; arg++)
+        {
+            std::string option = argv[arg];
+            if (option == "--delta")
+            {
+                flags |= TRACE_FLAG_DELTA;
+            }
+            else if (option == "--cores")
+            {
+                flags |= TRACE_FLAG_CORE;
+            }
+            else if (option == "--wide")
+            {
+                flags |= TRACE_FLAG_WIDE;
+            }
+            else
+            {
+                std::cerr << "Invalid input. Exiting.\n";
+                return 1;
+            }
+        }
+        return convertTrace(nullptr, argv[2], flags);
+    }
+
+    // STACK DISTANCE MODE: ./csim stack <number of sets> <block size> <max set size> [--validate] < tracefile
+    if (argc >= 2 && std::string(argv[1]) == "stack")
+    {
+        if (argc < 5 || argc > 6 || (argc == 6 && std::string(argv[5]) != "--validate"))
+        {
+            std::cerr << "Invalid input. Exiting.\n";
+            return 1;
+        }
+        int numSets = std::atoi(argv[2]);
+        int numBytes = std::atoi(argv[3]);
+        int maxBlocks = std::atoi(argv[4]);
+        if (validateArguments(numSets, maxBlocks, numBytes, "write-allocate", "write-back", "lru") == 1)
+        {
+            return 1;
+        }
+
+        StackDistance analysis;
+        stackSetUp(analysis, numSets, numBytes, maxBlocks);
+
+        // with --validate, also simulate every set size the usual way
+        std::vector<Cache> validation;
+        if (argc == 6)
+        {
+            for (int blocks = 1; blocks <= maxBlocks; blocks *= 2)
+            {
+                validation.emplace_back();
+                cacheSetUp(validation.back(), numSets, blocks, numBytes, "write-allocate", "write-back", "lru");
+            }
+        }
+
+        TraceReader reader;
+        if (traceOpen(reader, nullptr) == 1)
+        {
+            return 1;
+        }
+        runStackDistance(analysis, reader, validation);
+        traceClose(reader);
+
+        displayMissRatioCurve(analysis);
+        if (!validation.empty())
+        {
+            return validateStackDistance(analysis, validation);
+        }
+        return 0;
+    }
+
+    // HIERARCHY MODE: ./csim hierarchy [--timing <timing file>] <L1 level> <L2 level> ... < tracefile
+    // each level is sets:blocks:bytes:miss:write:eviction[:nine|inclusive|exclusive]
+    if (argc >= 2 && std::string(argv[1]) == "hierarchy")
+    {
+        int first = 2;
+        const char *timingPath = nullptr;
+        if (argc >= 4 && std::string(argv[2]) == "--timing")
+        {
+            timingPath = argv[3];
+            first = 4;
+        }
+        if (argc <= first)
+        {
+            std::cerr << "Invalid input. Exiting.\n";
+            return 1;
+        }
+        std::vector<Cache> levels(argc - first);
+        for (int i = first; i < argc; i++)
+        {
+            if (parseLevel(argv[i], levels[i - first]) == 1)
+            {
+                return 1;
+            }
+        }
+        if (hierarchySetUp(levels) == 1)
+        {
+            return 1;
+        }
+        if (timingPath)
+        {
+            std::vector<TimingModel> timing(levels.size());
+            if (readTimingFile(timingPath, timing) == 1)
+            {
+                return 1;
+            }
+            for (size_t i = 0; i < levels.size(); i++)
+            {
+                timingSetUp(levels[i], timing[i]);
+            }
+        }
+
+        TraceReader reader;
+        if (traceOpen(reader, nullptr) == 1)
+        {
+            return 1;
+        }
+        runHierarchy(levels, reader);
+        traceClose(reader);
+
+        displayHierarchy(levels);
+        return 0;
+    }
+
+    // MULTICORE MODE: ./csim multicore [--timing <timing file>] <number of cores> <private level> <shared level> < tracefile
+    if (argc >= 2 && std::string(argv[1]) == "multicore")
+    {
+        int first = 2;
+        const char *timingPath = nullptr;
+        if (argc >= 4 && std::string(argv[2]) == "--timing")
+        {
+            timingPath = argv[3];
+            first = 4;
+        }
+        if (argc - first != 3)
+        {
+            std::cerr << "Invalid input. Exiting.\n";
+            return 1;
+        }
+        Multicore system;
+        if (multicoreSetUp(system, std::atoi(argv[first]), argv[first + 1], argv[first + 2]) == 1)
+        {
+            return 1;
+        }
+        if (timingPath)
+        {
+            // L1 is every private cache, L2 the shared level
+            std::vector<TimingModel> timing(2);
+            if (readTimingFile(timingPath, timing) == 1)
+            {
+                return 1;
+            }
+            for (Cache &cache : system.cores)
+            {
+                timingSetUp(cache, timing[0]);
+            }
+            timingSetUp(system.sharedLevel, timing[1]);
+        }
+
+        TraceReader reader;
+        if (traceOpen(reader, nullptr) == 1)
+        {
+            return 1;
+        }
+        runMulticore(system, reader);
+        traceClose(reader);
+
+        displayMulticore(system);
+        return 0;
+    }
+
+    // STREAMS MODE: ./csim streams [--timing <timing file>] [--interleave round-robin|time|weighted:<w1>,<w2>,...]
+    //     [--quantum N] [--partition ucp[:<interval>]|<mask 1>,<mask 2>,...] <shared level> <trace 1> <trace 2> ...
+    if (argc >= 2 && std::string(argv[1]) == "streams")
+    {
+        int arg = 2;
+        const char *timingPath = nullptr;
+        std::string interleave = "round-robin";
+        const char *partition = nullptr;
+        long long quantum = 1;
+        while (arg + 1 < argc && std::string(argv[arg]).compare(0, 2, "--") == 0)
+        {
+            std::string option = argv[arg];
+            if (option == "--timing")
+            {
+                timingPath = argv[arg + 1];
+            }
+            else if (option == "--interleave")
+            {
+                interleave = argv[arg + 1];
+            }
+            else if (option == "--partition")
+            {
+                partition = argv[arg + 1];
+            }
+            else if (option == "--quantum")
+            {
+                quantum = std::atoll(argv[arg + 1]);
+                if (quantum < 1)
+                {
+                    std::cerr << "Invalid quantum, expected a positive number of accesses. Exiting.\n";
+                    return 1;
+                }
+            }
+            else
+            {
+                break;
+            }
+            arg += 2;
+        }
+        if (argc - arg < 2)
+        {
+            std::cerr << "Invalid input. Exiting.\n";
+            return 1;
+        }
+        StreamReplay replay;
+        replay.quantum = static_cast<uint64_t>(quantum);
+        if (parseLevel(argv[arg], replay.cache) == 1 || parseInterleave(interleave, argc - arg - 1, replay) == 1)
+        {
+            return 1;
+        }
+        if (partition)
+        {
+            if (parsePartition(partition, argc - arg - 1, replay.cache, replay.partition) == 1)
+            {
+                return 1;
+            }
+            partitionAttach(replay.partition, replay.cache);
+        }
+        if (timingPath)
+        {
+            std::vector<TimingModel> timing(1);
+            if (readTimingFile(timingPath, timing) == 1)
+            {
+                return 1;
+            }
+            timingSetUp(replay.cache, timing[0]);
+        }
+
+        if (streamsStart(replay, std::vector<std::string>(argv + arg + 1, argv + argc)) == 1)
+        {
+            return 1;
+        }
+        runStreams(replay);
+
+        displayStreams(replay);
+        return 0;
+    }
+
+    // SWEEP MODE: ./csim sweep [--table] [--threads N] [--timing <timing file>] (<six grid fields> | -f <config file>) < tracefile
+    if (argc >= 2 && std::string(argv[1]) == "sweep")
+    {
+        int arg = 2;
+        bool table = false;
+        int numThreads = 0; // one worker per hardware thread
+        const char *timingPath = nullptr;
+        while (arg < argc)
+        {
+            std::string option = argv[arg];
+            if (option == "--table")
+            {
+                table = true;
+                arg++;
+            }
+            else if (option == "--threads" && arg + 1 < argc)
+            {
+                numThreads = std::atoi(argv[arg + 1]);
+                if (numThreads < 1)
+                {
+                    std::cerr << "Invalid number of threads. Exiting.\n";
+                    return 1;
+                }
+                arg += 2;
+            }
+            else if (option == "--timing" && arg + 1 < argc)
+            {
+                timingPath = argv[arg + 1];
+                arg += 2;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        std::vector<SweepConfig> configs;
+        if (argc - arg == 2 && std::string(argv[arg]) == "-f")
+        {
+            if (readSweepFile(argv[arg + 1], configs) == 1)
+            {
+                return 1;
+            }
+        }
+        else if (argc - arg == 6)
+        {
+            if (expandSweepGrid(std::vector<std::string>(argv + arg, argv + argc), configs) == 1)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "Invalid input. Exiting.\n";
+            return 1;
+        }
+        if (configs.empty())
+        {
+            std::cerr << "Invalid input, no sweep configurations. Exiting.\n";
+            return 1;
+        }
+
+        std::vector<Cache> caches;
+        sweepSetUp(configs, caches);
+        if (timingPath)
+        {
+            // every configuration is a single level
+            std::vector<TimingModel> timing(1);
+            if (readTimingFile(timingPath, timing) == 1)
+            {
+                return 1;
+            }
+            for (Cache &cache : caches)
+            {
+                timingSetUp(cache, timing[0]);
+            }
+        }
+
+        TraceReader reader;
+        if (traceOpen(reader, nullptr) == 1)
+        {
+            return 1;
+        }
+        runSweepParallel(caches, reader, numThreads);
+        traceClose(reader);
+
+        displaySweep(configs, caches, table);
+        return 0;
+    }
+
     // PARAMETER HANDLING
 
-    // check that all inputs were included
-    if (argc != 7)
+    // check that all inputs were included, optionally followed by
+    // --timing <timing file>, --interval <accesses> | --interval-seconds <seconds>, --csv,
+    // --sample-sets <ratio>, --sample-windows <window>:<period>[:<warmup>], --warmup <accesses>,
+    // --restore <checkpoint>, --checkpoint <checkpoint>, --prefetch <kind>[:<degree>[:<distance>]],
+    // --classify, --hotspots, --regions <region map>, --generate <pattern>[:<key>=<value>...]
+    // and --victim <entries>[:<latency>]
+    if (argc < 7)
     {
         std::cerr << "Invalid input. Exiting.\n";
         return 1;
     }
+    const char *timingPath = nullptr;
+    IntervalReporter intervals;
+    Sampler sampler;
+    bool sampling = false;
+    long long warmup = -1; // none
+    const char *restorePath = nullptr;
+    const char *checkpointPath = nullptr;
+    Prefetcher prefetcher;
+    bool prefetching = false;
+    MissClassifier classifier;
+    bool classifying = false;
+    HotSpots hotSpots;
+    bool profiling = false;
+    SyntheticGenerator generator;
+    bool generating = false;
+    VictimCache victimCache;
+    bool victimCaching = false;
+    for (int arg = 7; arg < argc; arg++)
+    {
+        std::string option = argv[arg];
+        if (option == "--timing" && arg + 1 < argc)
+        {
+            timingPath = argv[++arg];
+        }
+        else if (option == "--interval" && arg + 1 < argc)
+        {
+            long long accesses = std::atoll(argv[++arg]);
+            if (accesses < 1)
+            {
+                std::cerr << "Invalid interval. Exiting.\n";
+                return 1;
+            }
+            intervals.everyAccesses = accesses;
+        }
+        else if (option == "--interval-seconds" && arg + 1 < argc)
+        {
+            intervals.everySeconds = std::atof(argv[++arg]);
+            if (!(intervals.everySeconds > 0))
+            {
+                std::cerr << "Invalid interval. Exiting.\n";
+                return 1;
+            }
+        }
+        else if (option == "--csv")
+        {
+            intervals.csv = true;
+        }
+        else if (option == "--sample-sets" && arg + 1 < argc)
+        {
+            sampler.setRatio = std::atoi(argv[++arg]);
+            sampling = true;
+        }
+        else if (option == "--sample-windows" && arg + 1 < argc)
+        {
+            if (parseSampleWindows(argv[++arg], sampler) == 1)
+            {
+                return 1;
+            }
+            sampling = true;
+        }
+        else if (option == "--warmup" && arg + 1 < argc)
+        {
+            warmup = std::atoll(argv[++arg]);
+            if (warmup < 0)
+            {
+                std::cerr << "Invalid warmup. Exiting.\n";
+                return 1;
+            }
+        }
+        else if (option == "--restore" && arg + 1 < argc)
+        {
+            restorePath = argv[++arg];
+        }
+        else if (option == "--checkpoint" && arg + 1 < argc)
+        {
+            checkpointPath = argv[++arg];
+        }
+        else if (option == "--prefetch" && arg + 1 < argc)
+        {
+            if (parsePrefetcher(argv[++arg], prefetcher) == 1)
+            {
+                return 1;
+            }
+            prefetching = true;
+        }
+        else if (option == "--classify")
+        {
+            classifying = true;
+        }
+        else if (option == "--hotspots")
+        {
+            profiling = true;
+        }
+        else if (option == "--regions" && arg + 1 < argc)
+        {
+            if (readRegionMap(argv[++arg], hotSpots) == 1)
+            {
+                return 1;
+            }
+            profiling = true;
+        }
+        else if (option == "--generate" && arg + 1 < argc)
+        {
+            if (parseGenerator(argv[++arg], generator) == 1)
+            {
+                return 1;
+            }
+            generating = true;
+        }
+        else if (option == "--victim" && arg + 1 < argc)
+        {
+            if (parseVictimCache(argv[++arg], victimCache) == 1)
+            {
+                return 1;
+            }
+            victimCaching = true;
+        }
+        else
+        {
+            std::cerr << "Invalid input. Exiting.\n";
+            return 1;
+        }
+    }
+    if (intervals.everyAccesses && intervals.everySeconds > 0)
+    {
+        std::cerr << "Invalid input, use either --interval or --interval-seconds. Exiting.\n";
+        return 1;
+    }
+    bool streaming = intervals.everyAccesses || intervals.everySeconds > 0;
+    if (streaming && sampling)
+    {
+        std::cerr << "Invalid input, interval statistics cannot be sampled. Exiting.\n";
+        return 1;
+    }
+    if (prefetching && sampling)
+    {
+        std::cerr << "Invalid input, prefetching cannot be sampled. Exiting.\n";
+        return 1;
+    }
+    if (classifying && sampling)
+    {
+        std::cerr << "Invalid input, miss classification cannot be sampled. Exiting.\n";
+        return 1;
+    }
+    if (profiling && sampling)
+    {
+        std::cerr << "Invalid input, hot-spot histograms cannot be sampled. Exiting.\n";
+        return 1;
+    }
+    if (victimCaching && sampling)
+    {
+        std::cerr << "Invalid input, a victim cache cannot be sampled. Exiting.\n";
+        return 1;
+    }
 
     int numSets = std::atoi(argv[1]);
     int numBlocks = std::atoi(argv[2]);
@@ -30,22 +552,150 @@ int main(int argc, char *argv[])
     // SET UP CACHE
     Cache cache;
     cacheSetUp(cache, numSets, numBlocks, numBytes, handleMiss, handleWrite, handleEviction);
+    if (timingPath)
+    {
+        std::vector<TimingModel> timing(1);
+        if (readTimingFile(timingPath, timing) == 1)
+        {
+            return 1;
+        }
+        timingSetUp(cache, timing[0]);
+    }
+    if (restorePath && checkpointRestore(cache, restorePath) == 1)
+    {
+        return 1;
+    }
+    if (sampling && samplerSetUp(sampler, cache) == 1)
+    {
+        return 1;
+    }
+    if (victimCaching)
+    {
+        victimCacheAttach(victimCache, cache);
+    }
+    if (prefetching)
+    {
+        prefetcherAttach(prefetcher, cache);
+    }
+    if (classifying)
+    {
+        missClassifierAttach(classifier, cache); // classifies the demand misses left after prefetching
+    }
+    if (profiling)
+    {
+        hotSpotAttach(hotSpots, cache);
+    }
 
     // RUN SIMULATOR
     // Note: assumes all input data from file is valid
 
-    char loadStore;   // 1
-    uint32_t address; // 2
-    std::string addressString;
-    std::string thirdField; // 3 (placeholder)
+    // trace comes from stdin: mapped in place when redirected from a file, streamed otherwise;
+    // text and binary traces are told apart by the binary header. A synthetic trace replaces it
+    TraceReader reader;
+    if (!generating && traceOpen(reader, nullptr) == 1)
+    {
+        return 1;
+    }
 
-    // get info from trace file
-    while (std::cin >> loadStore >> addressString >> thirdField)
+    // the first `warmup` accesses only fill the cache; statistics restart after them
+    // (including any restored from a checkpoint)
+    uint64_t warmupLeft = warmup > 0 ? warmup : 0;
+    if (warmup == 0)
     {
-        address = std::stoul(addressString, nullptr, 16);
-        cacheSimulator(cache, loadStore, address);
+        cacheClearStatistics(cache);
+    }
+    if (streaming && warmupLeft == 0)
+    {
+        intervalStart(intervals, cache);
     }
 
+    // get info from trace file or generator, a batch at a time
+    TraceBatch batch;
+    while ((generating ? generatorNextBatch(generator, batch) : traceNextBatch(reader, batch)) > 0)
+    {
+        const char *loadStore = batch.loadStore.data();
+        const uint64_t *addresses = batch.addresses.data();
+        size_t count = batch.count;
+        if (warmupLeft > 0)
+        {
+            size_t warm = std::min<uint64_t>(count, warmupLeft);
+            cacheSimulateBatch(cache, loadStore, addresses, warm);
+            loadStore += warm;
+            addresses += warm;
+            count -= warm;
+            warmupLeft -= warm;
+            if (warmupLeft > 0)
+            {
+                continue;
+            }
+            cacheClearStatistics(cache);
+            if (streaming)
+            {
+                intervalStart(intervals, cache);
+            }
+        }
+
+        if (streaming)
+        {
+            intervalSimulate(intervals, cache, loadStore, addresses, count);
+        }
+        else if (sampling)
+        {
+            samplerSimulate(sampler, cache, loadStore, addresses, count);
+        }
+        else
+        {
+            cacheSimulateBatch(cache, loadStore, addresses, count);
+        }
+    }
+    if (!generating)
+    {
+        traceClose(reader);
+    }
+    if (warmupLeft > 0)
+    {
+        // the whole trace was warmup
+        cacheClearStatistics(cache);
+        if (streaming)
+        {
+            intervalStart(intervals, cache);
+        }
+    }
+    if (streaming)
+    {
+        intervalFinish(intervals, cache);
+    }
+    timingDrain(cache); // outstanding misses and buffered writes
+
+    if (checkpointPath && checkpointSave(cache, checkpointPath) == 1)
+    {
+        return 1;
+    }
+    if (sampling)
+    {
+        displaySampled(sampler);
+        return 0;
+    }
     displayStatistics(cache); // prints final caching statistics
+    if (victimCaching)
+    {
+        displayVictimCacheStatistics(victimCache);
+    }
+    if (cache.timing.writeBufferDepth > 0)
+    {
+        displayWriteBufferStatistics(cache);
+    }
+    if (prefetching)
+    {
+        displayPrefetchStatistics(prefetcher, cache);
+    }
+    if (classifying)
+    {
+        displayMissClasses(classifier);
+    }
+    if (profiling)
+    {
+        displayHotSpots(hotSpots, intervals.csv);
+    }
     return 0;
 }
\ No newline at end of file
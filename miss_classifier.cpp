@@ -0,0 +1,292 @@
+#include <iostream>
+#include <algorithm>
+
+#include "miss_classifier.h"
+
+// first-touch set slots before it first grows
+static const size_t CLASSIFIER_INITIAL_SLOTS = 1 << 16;
+// how many accesses ahead a batch looks up slots, buckets and cache sets
+static const size_t CLASSIFIER_PREFETCH_DISTANCE = 8;
+
+static inline size_t hashBlock(uint64_t block)
+{
+    block *= 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(block ^ (block >> 29));
+}
+
+// doubles the first-touch set
+static void growSeen(MissClassifier &classifier)
+{
+    std::vector<SeenSlot> seen(classifier.seen.size() * 2);
+    size_t mask = seen.size() - 1;
+    for (const SeenSlot &entry : classifier.seen)
+    {
+        if (entry.key != 0)
+        {
+            size_t slot = hashBlock(entry.key - 1) & mask;
+            while (seen[slot].key != 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            seen[slot] = entry;
+        }
+    }
+    classifier.seen.swap(seen);
+}
+
+// the first-touch slot of a block, added if the block was never seen
+static SeenSlot &markSeen(MissClassifier &classifier, uint64_t block, bool &firstTouch)
+{
+    if (2 * (classifier.seenCount + 1) > classifier.seen.size())
+    {
+        growSeen(classifier);
+    }
+    uint64_t key = block + 1; // blocks are addresses shifted by at least 2, so this never wraps
+    size_t mask = classifier.seen.size() - 1;
+    size_t slot = hashBlock(block) & mask;
+    while (classifier.seen[slot].key != key && classifier.seen[slot].key != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    firstTouch = classifier.seen[slot].key == 0;
+    if (firstTouch)
+    {
+        classifier.seen[slot].key = key;
+        classifier.seenCount++;
+    }
+    return classifier.seen[slot];
+}
+
+static inline int32_t &bucketOf(MissClassifier &classifier, uint64_t block)
+{
+    return classifier.buckets[hashBlock(block) & (classifier.buckets.size() - 1)];
+}
+
+// the shadow node holding a block, or -1
+static int32_t findNode(MissClassifier &classifier, uint64_t block)
+{
+    int32_t id = bucketOf(classifier, block);
+    while (id >= 0 && classifier.nodes[id].block != block)
+    {
+        id = classifier.nodes[id].chain;
+    }
+    return id;
+}
+
+static void unlinkNode(MissClassifier &classifier, int32_t id)
+{
+    ShadowNode &node = classifier.nodes[id];
+    if (node.prev >= 0)
+    {
+        classifier.nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        classifier.head = node.next;
+    }
+    if (node.next >= 0)
+    {
+        classifier.nodes[node.next].prev = node.prev;
+    }
+    else
+    {
+        classifier.tail = node.prev;
+    }
+}
+
+static void pushFront(MissClassifier &classifier, int32_t id)
+{
+    ShadowNode &node = classifier.nodes[id];
+    node.prev = -1;
+    node.next = classifier.head;
+    if (classifier.head >= 0)
+    {
+        classifier.nodes[classifier.head].prev = id;
+    }
+    else
+    {
+        classifier.tail = id;
+    }
+    classifier.head = id;
+}
+
+// moves the blocks of a shadow that has just filled up into nodes, linked in last-use order
+static void buildShadow(MissClassifier &classifier)
+{
+    std::vector<const SeenSlot *> resident;
+    resident.reserve(classifier.resident);
+    for (const SeenSlot &entry : classifier.seen)
+    {
+        if (entry.lastUse != 0)
+        {
+            resident.push_back(&entry);
+        }
+    }
+    std::sort(resident.begin(), resident.end(), [](const SeenSlot *a, const SeenSlot *b)
+              { return a->lastUse < b->lastUse; });
+
+    size_t buckets = 1;
+    while (buckets < 2 * classifier.shadowBlocks)
+    {
+        buckets *= 2;
+    }
+    classifier.buckets.assign(buckets, -1);
+    classifier.nodes.assign(resident.size(), ShadowNode());
+    for (size_t i = 0; i < resident.size(); i++)
+    {
+        int32_t id = static_cast<int32_t>(i);
+        int32_t &bucket = bucketOf(classifier, resident[i]->key - 1);
+        classifier.nodes[id].block = resident[i]->key - 1;
+        classifier.nodes[id].chain = bucket;
+        bucket = id;
+        pushFront(classifier, id);
+    }
+    classifier.full = true;
+}
+
+// brings a block into the full shadow in place of its least recently used one
+static void replaceTail(MissClassifier &classifier, uint64_t block)
+{
+    int32_t id = classifier.tail;
+    unlinkNode(classifier, id);
+    int32_t *link = &bucketOf(classifier, classifier.nodes[id].block);
+    while (*link != id)
+    {
+        link = &classifier.nodes[*link].chain;
+    }
+    *link = classifier.nodes[id].chain;
+
+    int32_t &bucket = bucketOf(classifier, block);
+    classifier.nodes[id].block = block;
+    classifier.nodes[id].chain = bucket;
+    bucket = id;
+    pushFront(classifier, id);
+}
+
+// the access path of a classified cache: the cache's own access, then the shadow
+static void classifyAccess(Cache &cache, char loadStore, uint64_t address)
+{
+    MissClassifier &classifier = *cache.missClassifier;
+    uint64_t misses = cache.loadMisses + cache.storeMisses;
+    classifier.inner(cache, loadStore, address);
+    bool miss = cache.loadMisses + cache.storeMisses != misses;
+
+    // another access to the most recent block changes nothing in the shadow
+    uint64_t block = address >> cache.offsetBits;
+    classifier.accesses++;
+    if (block == classifier.lastBlock)
+    {
+        classifier.conflict += miss;
+        return;
+    }
+    classifier.lastBlock = block;
+    bool allocate = loadStore == 'l' || cache.missPolicy == MissPolicy::WriteAllocate;
+
+    bool firstTouch = false;
+    bool shadowHit;
+    if (!classifier.full)
+    {
+        SeenSlot &slot = markSeen(classifier, block, firstTouch);
+        shadowHit = slot.lastUse != 0;
+        if (shadowHit || allocate)
+        {
+            slot.lastUse = classifier.accesses;
+        }
+        if (!shadowHit && allocate && ++classifier.resident == classifier.shadowBlocks)
+        {
+            buildShadow(classifier);
+        }
+    }
+    else
+    {
+        int32_t id = findNode(classifier, block);
+        shadowHit = id >= 0;
+        if (shadowHit)
+        {
+            unlinkNode(classifier, id);
+            pushFront(classifier, id);
+        }
+        else
+        {
+            markSeen(classifier, block, firstTouch);
+            if (allocate)
+            {
+                replaceTail(classifier, block);
+            }
+        }
+    }
+    if (!shadowHit && !allocate)
+    {
+        classifier.lastBlock = UINT64_MAX; // not brought in
+    }
+
+    if (miss)
+    {
+        if (shadowHit)
+        {
+            classifier.conflict++; // the fully associative cache would have hit
+        }
+        else if (firstTouch)
+        {
+            classifier.compulsory++;
+        }
+        else
+        {
+            classifier.capacity++;
+        }
+    }
+}
+
+static void classifyBatch(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count)
+{
+    MissClassifier &classifier = *cache.missClassifier;
+    for (size_t i = 0; i < count; i++)
+    {
+        // the cache set of an access ahead, its first-touch slot and, once the shadow is full, its bucket
+        if (i + CLASSIFIER_PREFETCH_DISTANCE < count)
+        {
+            uint64_t block = addresses[i + CLASSIFIER_PREFETCH_DISTANCE] >> cache.offsetBits;
+            size_t hash = hashBlock(block);
+            cachePrefetchSet(cache, static_cast<int>(block & cache.indexMask));
+            if (classifier.full)
+            {
+                __builtin_prefetch(&classifier.buckets[hash & (classifier.buckets.size() - 1)]);
+            }
+            __builtin_prefetch(&classifier.seen[hash & (classifier.seen.size() - 1)], 1);
+        }
+        classifyAccess(cache, loadStore[i], addresses[i]);
+    }
+}
+
+void missClassifierAttach(MissClassifier &classifier, Cache &cache)
+{
+    classifier.seen.assign(CLASSIFIER_INITIAL_SLOTS, SeenSlot());
+    classifier.seenCount = 0;
+    classifier.shadowBlocks = static_cast<uint64_t>(cache.numSets) * cache.numBlocks;
+    classifier.resident = 0;
+    classifier.full = false;
+    classifier.buckets.clear();
+    classifier.nodes.clear();
+    classifier.head = classifier.tail = -1;
+    classifier.accesses = 0;
+    classifier.lastBlock = UINT64_MAX;
+    missClassifierClearStatistics(classifier);
+    classifier.inner = cache.simulate;
+    cache.missClassifier = &classifier;
+    cache.simulate = classifyAccess;
+    cache.simulateBatch = classifyBatch;
+}
+
+void missClassifierClearStatistics(MissClassifier &classifier)
+{
+    classifier.compulsory = 0;
+    classifier.capacity = 0;
+    classifier.conflict = 0;
+}
+
+void displayMissClasses(const MissClassifier &classifier)
+{
+    std::cout << "Compulsory misses: " << classifier.compulsory << std::endl;
+    std::cout << "Capacity misses: " << classifier.capacity << std::endl;
+    std::cout << "Conflict misses: " << classifier.conflict << std::endl;
+}
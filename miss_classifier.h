@@ -0,0 +1,100 @@
+#ifndef MISS_CLASSIFIER_H
+#define MISS_CLASSIFIER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "cache_simulator.h"
+
+// MISS CLASSIFICATION (3C)
+//
+// Splits a cache's misses into
+// - compulsory: the first access to a block;
+// - capacity: misses that a fully associative LRU cache with as many blocks
+//   would also have;
+// - conflict: the rest, misses that only the set mapping causes.
+// Every block seen has a slot in an open-addressing first-touch set. Until
+// the fully associative shadow is full nothing is evicted from it, so the
+// slot's last use also tells whether the shadow holds the block, and each
+// access is one probe. When the shadow fills up, its blocks move to a pool of
+// as many nodes as the cache has blocks, chained from hash buckets and linked
+// into an LRU list in last-use order: each access is then one lookup and O(1)
+// list updates in a structure no bigger than the cache, and the first-touch
+// set is only probed when the shadow misses. Batches look up the slots,
+// buckets and cache sets of upcoming accesses ahead of time.
+// The shadow allocates like the cache does: a no-write-allocate store does
+// not bring a block into it.
+
+/**
+ * Struct representing a block in the first-touch set.
+ */
+struct SeenSlot
+{
+    uint64_t key = 0;     // Block + 1 (0: empty)
+    uint64_t lastUse = 0; // While the shadow fills: access count at the block's last use (0: not in the shadow)
+};
+
+/**
+ * Struct representing a block held by the full shadow.
+ */
+struct ShadowNode
+{
+    uint64_t block = 0;
+    int32_t chain = -1; // Next node in the same hash bucket (-1 at the end)
+    int32_t prev = -1;  // Next more recently used node (-1 at the head)
+    int32_t next = -1;  // Next less recently used node (-1 at the tail)
+};
+
+/**
+ * Struct representing the classifier of one cache and its counts.
+ */
+struct MissClassifier
+{
+    // FIRST-TOUCH SET: linear probing, at most half full
+    std::vector<SeenSlot> seen;
+    size_t seenCount = 0;
+
+    // FULLY ASSOCIATIVE LRU SHADOW
+    uint64_t shadowBlocks = 0;     // Blocks it holds, as many as the cache
+    uint64_t resident = 0;         // Blocks it holds so far
+    bool full = false;             // The blocks have moved to nodes
+    std::vector<int32_t> buckets;  // Per hash bucket: first node (-1: empty), at least twice as many as nodes
+    std::vector<ShadowNode> nodes; // One per block of the full shadow
+    int32_t head = -1;             // Most recently used node
+    int32_t tail = -1;             // Victim
+    uint64_t accesses = 0;         // Accesses classified, the clock of lastUse
+    uint64_t lastBlock = UINT64_MAX; // Block of the previous access if the shadow holds it, the most recent one
+
+    AccessFunction inner = nullptr; // The cache's access path before attaching
+
+    // STATISTICS
+    uint64_t compulsory = 0;
+    uint64_t capacity = 0;
+    uint64_t conflict = 0;
+};
+
+/**
+ * Attaches a classifier to a cache, clearing it, so that every later
+ * cacheSimulator and cacheSimulateBatch call is classified. Attach after any
+ * prefetcher.
+ *
+ * @param classifier Reference to the MissClassifier, which must outlive the cache's use.
+ * @param cache Reference to the Cache, already set up by cacheSetUp.
+ */
+void missClassifierAttach(MissClassifier &classifier, Cache &cache);
+
+/**
+ * Clears a classifier's counts, keeping the blocks it has seen.
+ *
+ * @param classifier Reference to the MissClassifier.
+ */
+void missClassifierClearStatistics(MissClassifier &classifier);
+
+/**
+ * Displays the compulsory, capacity and conflict miss counts.
+ *
+ * @param classifier Reference to the MissClassifier.
+ */
+void displayMissClasses(const MissClassifier &classifier);
+
+#endif // MISS_CLASSIFIER_H
@@ -0,0 +1,166 @@
+#include <iostream>
+
+#include "multicore.h"
+#include "hierarchy.h"
+
+int multicoreSetUp(Multicore &system, int numCores, const std::string &privateSpec, const std::string &sharedSpec)
+{
+    if (numCores < 1)
+    {
+        std::cerr << "Invalid number of cores. Exiting.\n";
+        return 1;
+    }
+    if (parseLevel(sharedSpec, system.sharedLevel) == 1)
+    {
+        return 1;
+    }
+    if (system.sharedLevel.inclusion != InclusionPolicy::NINE)
+    {
+        std::cerr << "Invalid input, the shared level cannot be inclusive or exclusive. Exiting.\n";
+        return 1;
+    }
+
+    system.cores.clear();
+    system.cores.resize(numCores);
+    system.state.assign(numCores, CoreState());
+    for (int core = 0; core < numCores; core++)
+    {
+        Cache &cache = system.cores[core];
+        if (parseLevel(privateSpec, cache) == 1)
+        {
+            return 1;
+        }
+        if (cache.missPolicy != MissPolicy::WriteAllocate || cache.writePolicy != WritePolicy::WriteBack)
+        {
+            std::cerr << "Invalid input, private caches must be write-allocate and write-back. Exiting.\n";
+            return 1;
+        }
+        if (cache.numBytes > system.sharedLevel.numBytes)
+        {
+            std::cerr << "Invalid input, block size shrinks from the private caches to the shared level. Exiting.\n";
+            return 1;
+        }
+        cache.inclusion = InclusionPolicy::NINE;
+        cache.nextLevel = &system.sharedLevel;
+        system.state[core].shared.assign(static_cast<size_t>(cache.numSets) * cache.wayStride, 0);
+    }
+    return 0;
+}
+
+// writes a Modified copy held by another core back to the shared level, charging the requester
+static void flushBlock(Multicore &system, Cache &requester, Cache &owner, CoreState &ownerState, int index, int way)
+{
+    Cache &shared = system.sharedLevel;
+    uint64_t before = shared.totalCycles;
+    shared.simulate(shared, 's', blockAddress(owner, index, owner.tagAt(owner.slot(index, way))));
+    requester.totalCycles += shared.totalCycles - before;
+    owner.setDirty(index, way, false);
+    owner.writeBacks++;
+    ownerState.flushes++;
+}
+
+void multicoreAccess(Multicore &system, const TraceRecord &record)
+{
+    int core = record.core % system.cores.size();
+    Cache &cache = system.cores[core];
+    CoreState &state = system.state[core];
+    uint64_t address = record.address;
+
+    // every private cache has the same geometry, so one decode serves them all
+    int index = calculateIndex(address, cache);
+    uint64_t tag = calculateTag(address, cache);
+    int way = findBlock(tag, index, cache);
+    uint64_t block = blockAddress(cache, index, tag);
+    if (way < 0 && !state.invalidated.empty() && state.invalidated.erase(block))
+    {
+        state.coherenceMisses++;
+    }
+
+    bool store = record.loadStore == 's';
+    if (store && way >= 0 && state.shared[cache.slot(index, way)])
+    {
+        state.upgrades++;
+    }
+
+    // snoop the other cores: stores invalidate every copy, load misses downgrade them to Shared
+    bool sharers = false;
+    if (store || way < 0)
+    {
+        for (size_t other = 0; other < system.cores.size(); other++)
+        {
+            if (static_cast<int>(other) == core)
+            {
+                continue;
+            }
+            Cache &peer = system.cores[other];
+            CoreState &peerState = system.state[other];
+            int peerWay = findBlock(tag, index, peer);
+            if (peerWay < 0)
+            {
+                continue;
+            }
+            if (peer.isDirty(index, peerWay))
+            {
+                flushBlock(system, cache, peer, peerState, index, peerWay);
+            }
+            if (store)
+            {
+                cacheInvalidate(peer, index, peerWay);
+                peerState.invalidations++;
+                peerState.invalidated.insert(block);
+            }
+            else
+            {
+                peerState.shared[peer.slot(index, peerWay)] = 1;
+                sharers = true;
+            }
+        }
+    }
+
+    cacheSimulator(cache, record.loadStore, address);
+
+    // a store leaves the block Modified (the dirty bit); a load miss fills it Exclusive or Shared
+    if (store || way < 0)
+    {
+        way = findBlock(tag, index, cache);
+        state.shared[cache.slot(index, way)] = sharers ? 1 : 0;
+    }
+}
+
+void runMulticore(Multicore &system, TraceReader &reader)
+{
+    TraceRecord record;
+    while (traceNext(reader, record))
+    {
+        multicoreAccess(system, record);
+    }
+    for (Cache &cache : system.cores)
+    {
+        timingDrain(cache);
+    }
+    timingDrain(system.sharedLevel);
+}
+
+void displayMulticore(Multicore &system)
+{
+    for (size_t core = 0; core < system.cores.size(); core++)
+    {
+        if (core > 0)
+        {
+            std::cout << std::endl;
+        }
+        Cache &cache = system.cores[core];
+        CoreState &state = system.state[core];
+        std::cout << "Core " << core << ":" << std::endl;
+        displayStatistics(cache);
+        std::cout << "Write-backs: " << cache.writeBacks << std::endl;
+        std::cout << "Coherence misses: " << state.coherenceMisses << std::endl;
+        std::cout << "Invalidations: " << state.invalidations << std::endl;
+        std::cout << "Upgrades: " << state.upgrades << std::endl;
+        std::cout << "Flushes: " << state.flushes << std::endl;
+    }
+    std::cout << std::endl;
+    std::cout << "Shared:" << std::endl;
+    displayStatistics(system.sharedLevel);
+    std::cout << "Write-backs: " << system.sharedLevel.writeBacks << std::endl;
+}
@@ -0,0 +1,93 @@
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "cache_simulator.h"
+#include "trace_reader.h"
+
+// MULTICORE SIMULATION WITH MESI COHERENCE
+//
+// Every core has a private write-back cache in front of one shared level, and
+// trace records are dispatched to cores by their core field. The private
+// caches are kept coherent by snooping the other cores on every miss and on
+// every store:
+//
+// - Modified: the dirty bit of a private block;
+// - Exclusive: a clean block no other core holds;
+// - Shared: a clean block other cores may hold (CoreState::shared);
+// - Invalid: not valid.
+//
+// A load miss downgrades the other copies to Shared; a Modified copy is first
+// flushed to the shared level. A store invalidates every other copy, flushing
+// a Modified one, and leaves the writer Modified. Flushes are shared-level
+// stores charged to the core that caused them. The shared level only sees
+// fills and write-backs, so it is always non-inclusive.
+
+/**
+ * Struct representing the coherence state and counters of one core.
+ */
+struct CoreState
+{
+    std::vector<uint8_t> shared;              // Per slot: the clean block is Shared rather than Exclusive
+    std::unordered_set<uint64_t> invalidated; // Blocks another core's store took away, until refetched
+
+    // COHERENCE STATISTICS
+    uint64_t coherenceMisses = 0; // Misses on blocks lost to an invalidation
+    uint64_t invalidations = 0;   // Copies this core lost to other cores' stores
+    uint64_t upgrades = 0;        // Stores that hit a Shared block and had to invalidate the others
+    uint64_t flushes = 0;         // Modified copies written back because another core wanted the block
+};
+
+/**
+ * Struct representing a group of cores with private caches over a shared level.
+ * Core caches point at sharedLevel, so the struct must not move once set up.
+ */
+struct Multicore
+{
+    std::vector<Cache> cores;
+    std::vector<CoreState> state;
+    Cache sharedLevel;
+};
+
+/**
+ * Sets up the cores and the shared level from two level specifications in the
+ * hierarchy format (sets:blocks:bytes:miss:write:eviction).
+ * The private caches must be write-allocate and write-back.
+ *
+ * @param system Reference to the Multicore to initialize.
+ * @param numCores The number of cores.
+ * @param privateSpec Configuration of every private cache.
+ * @param sharedSpec Configuration of the shared level.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int multicoreSetUp(Multicore &system, int numCores, const std::string &privateSpec, const std::string &sharedSpec);
+
+/**
+ * Simulates one access on its core, including the coherence actions at the other cores.
+ * Core ids at or above the number of cores wrap around.
+ *
+ * @param system Reference to the Multicore being simulated.
+ * @param record The access.
+ */
+void multicoreAccess(Multicore &system, const TraceRecord &record);
+
+/**
+ * Simulates every record of a trace in trace order.
+ *
+ * @param system Reference to the Multicore being simulated.
+ * @param reader Reference to an open TraceReader.
+ */
+void runMulticore(Multicore &system, TraceReader &reader);
+
+/**
+ * Displays the statistics of every core, then of the shared level.
+ *
+ * @param system Reference to the simulated Multicore.
+ */
+void displayMulticore(Multicore &system);
+
+#endif // MULTICORE_H
@@ -0,0 +1,187 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "partition.h"
+
+// the mask of count ways starting at way first
+static uint64_t wayRun(int first, int count)
+{
+    uint64_t run = count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+    return run << first;
+}
+
+int parsePartition(const std::string &spec, int numClasses, const Cache &cache, WayPartition &partition)
+{
+    if (cache.numBlocks > 64 || numClasses > cache.numBlocks)
+    {
+        std::cerr << "Invalid partition, the cache needs at most 64 ways and at least one way per class. Exiting.\n";
+        return 1;
+    }
+    partition.numClasses = numClasses;
+    partition.masks.assign(numClasses, 0);
+
+    if (spec.compare(0, 3, "ucp") == 0)
+    {
+        partition.dynamic = true;
+        partition.interval = PARTITION_DEFAULT_INTERVAL;
+        if (spec.size() > 3)
+        {
+            char *end;
+            partition.interval = spec[3] == ':' ? std::strtoull(spec.c_str() + 4, &end, 10) : 0;
+            if (spec[3] != ':' || spec.size() == 4 || *end != '\0' || spec[4] == '-' || partition.interval == 0)
+            {
+                std::cerr << "Invalid partition " << spec << ", expected ucp:<accesses between repartitions>. Exiting.\n";
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    partition.dynamic = false;
+    uint64_t allWays = wayRun(0, cache.numBlocks);
+    std::stringstream stream(spec);
+    std::string field;
+    int count = 0;
+    while (std::getline(stream, field, ','))
+    {
+        char *end;
+        uint64_t mask = std::strtoull(field.c_str(), &end, 16);
+        // a nonzero run of contiguous ways within the cache
+        uint64_t run = mask >> (mask ? __builtin_ctzll(mask) : 0);
+        if (field.empty() || field[0] == '-' || *end != '\0' || mask == 0 || (mask & ~allWays) != 0 ||
+            (run & (run + 1)) != 0 || count == numClasses)
+        {
+            std::cerr << "Invalid partition " << spec << ", expected ucp or one mask of contiguous ways per trace,"
+                      << " such as 0xff00,0x00ff. Exiting.\n";
+            return 1;
+        }
+        partition.masks[count++] = mask;
+    }
+    if (count != numClasses)
+    {
+        std::cerr << "Invalid partition " << spec << ", expected ucp or one mask of contiguous ways per trace,"
+                  << " such as 0xff00,0x00ff. Exiting.\n";
+        return 1;
+    }
+    return 0;
+}
+
+// gives each class a contiguous run of ways, in class order
+static void assignWays(WayPartition &partition, const std::vector<int> &allocation)
+{
+    int first = 0;
+    for (int cls = 0; cls < partition.numClasses; cls++)
+    {
+        partition.masks[cls] = wayRun(first, allocation[cls]);
+        first += allocation[cls];
+    }
+}
+
+void partitionAttach(WayPartition &partition, Cache &cache)
+{
+    partition.ways = cache.numBlocks;
+    partition.current = 0;
+    partition.owner.assign(static_cast<size_t>(cache.numSets) * cache.wayStride, 0);
+    partition.occupancy.assign(partition.numClasses, 0);
+    partition.repartitions = 0;
+    if (partition.dynamic)
+    {
+        // an even split to start with, the first classes taking the ways left over
+        std::vector<int> allocation(partition.numClasses, partition.ways / partition.numClasses);
+        for (int cls = 0; cls < partition.ways % partition.numClasses; cls++)
+        {
+            allocation[cls]++;
+        }
+        assignWays(partition, allocation);
+        size_t sampledSets = (cache.numSets + PARTITION_SAMPLE_STRIDE - 1) / PARTITION_SAMPLE_STRIDE;
+        partition.shadow.assign(partition.numClasses * sampledSets * partition.ways, 0);
+        partition.stackHits.assign(static_cast<size_t>(partition.numClasses) * partition.ways, 0);
+        partition.sinceRepartition = 0;
+    }
+    cache.partition = &partition;
+}
+
+// the lookahead algorithm: starting from one way each, repeatedly gives the class with the most
+// shadow hits per extra way the ways that earn them, until every way is given out
+static void repartition(WayPartition &partition)
+{
+    int ways = partition.ways;
+    std::vector<int> allocation(partition.numClasses, 1);
+    int balance = ways - partition.numClasses;
+    while (balance > 0)
+    {
+        int best = 0;
+        int bestWays = balance;
+        double bestUtility = -1;
+        for (int cls = 0; cls < partition.numClasses; cls++)
+        {
+            const uint64_t *hits = partition.stackHits.data() + static_cast<size_t>(cls) * ways;
+            uint64_t gained = 0;
+            for (int extra = 1; extra <= balance; extra++)
+            {
+                gained += hits[allocation[cls] + extra - 1];
+                double utility = static_cast<double>(gained) / extra;
+                if (utility > bestUtility)
+                {
+                    best = cls;
+                    bestWays = extra;
+                    bestUtility = utility;
+                }
+            }
+        }
+        allocation[best] += bestWays;
+        balance -= bestWays;
+    }
+
+    std::vector<uint64_t> previous = partition.masks;
+    assignWays(partition, allocation);
+    partition.repartitions += partition.masks != previous;
+    for (uint64_t &hits : partition.stackHits)
+    {
+        hits /= 2;
+    }
+}
+
+void partitionSelect(WayPartition &partition, Cache &cache, int cls, uint64_t address)
+{
+    partition.current = cls;
+    if (!partition.dynamic)
+    {
+        return;
+    }
+
+    int index = calculateIndex(address, cache);
+    if (index % PARTITION_SAMPLE_STRIDE == 0)
+    {
+        // the class's shadow set, kept in LRU stack order: a hit at position p would hit in
+        // any allocation of more than p ways
+        int ways = partition.ways;
+        size_t sampledSets = partition.shadow.size() / (static_cast<size_t>(partition.numClasses) * ways);
+        uint64_t *set = partition.shadow.data() + (cls * sampledSets + index / PARTITION_SAMPLE_STRIDE) * ways;
+        uint64_t key = calculateTag(address, cache) + 1;
+        int position = 0;
+        while (position < ways - 1 && set[position] != key && set[position] != 0)
+        {
+            position++;
+        }
+        if (set[position] == key)
+        {
+            partition.stackHits[static_cast<size_t>(cls) * ways + position]++;
+        }
+        std::memmove(set + 1, set, position * sizeof(uint64_t)); // a miss drops the LRU tag
+        set[0] = key;
+    }
+    if (++partition.sinceRepartition >= partition.interval)
+    {
+        repartition(partition);
+        partition.sinceRepartition = 0;
+    }
+}
+
+void displayPartitionClass(const WayPartition &partition, int cls)
+{
+    std::cout << "Way mask: 0x" << std::hex << partition.masks[cls] << std::dec << std::endl;
+    std::cout << "Occupancy: " << partition.occupancy[cls] << std::endl;
+}
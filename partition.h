@@ -0,0 +1,101 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+
+// WAY PARTITIONING
+//
+// Every access of a shared cache belongs to a class of service, and each class
+// has a mask of the ways it may fill, as with Intel CAT: a miss fills an
+// invalid way of its mask, or evicts the block the eviction policy picks among
+// the ways of its mask. Lookups still hit in any way, so blocks left in
+// another class's ways stay until that class evicts them. Masks are
+// contiguous runs of ways, as CAT requires, and only caches of up to 64 ways
+// can be partitioned.
+//
+// Masks are either given per class or chosen by utility-based cache
+// partitioning (Qureshi and Patt, "Utility-Based Cache Partitioning", MICRO
+// 2006): every PARTITION_SAMPLE_STRIDE-th set has one LRU shadow tag set per
+// class, as if the class had the whole cache, and counts the hits at each
+// LRU stack position. Every interval accesses the lookahead algorithm gives
+// the ways to the classes whose hits grow most per way, at least one way
+// each, and the counters are halved so older behaviour weighs less.
+
+// sets between two sets sampled by the utility monitors
+static const int PARTITION_SAMPLE_STRIDE = 32;
+// default accesses between two repartitions
+static const uint64_t PARTITION_DEFAULT_INTERVAL = 1 << 20;
+
+/**
+ * Struct representing the way masks of the classes of a shared cache, their
+ * occupancy and, when the partition is dynamic, their utility monitors.
+ */
+struct WayPartition
+{
+    // CONFIGURATION
+    int numClasses = 0;
+    std::vector<uint64_t> masks; // Per class: bit w set if the class may fill way w
+    bool dynamic = false;        // Indicates if the utility monitors repartition the cache
+    uint64_t interval = PARTITION_DEFAULT_INTERVAL; // Dynamic: accesses between repartitions
+
+    // STATE
+    int current = 0;                 // Class of the access being simulated
+    std::vector<uint8_t> owner;      // Per slot: the class that filled the block
+    std::vector<uint64_t> occupancy; // Per class: valid blocks it filled
+
+    // UTILITY MONITORS (dynamic only)
+    int ways = 0;                    // Ways of the cache, and of each shadow set
+    std::vector<uint64_t> shadow;    // Per class and sampled set: tags + 1 in LRU stack order, 0 when empty
+    std::vector<uint64_t> stackHits; // Per class and stack position: hits counted since the last halving
+    uint64_t sinceRepartition = 0;   // Accesses since the last repartition
+
+    // STATISTICS
+    uint64_t repartitions = 0;
+};
+
+/**
+ * Parses a partition "ucp[:interval]" or a list of one hexadecimal way mask
+ * per class "0xff00,0x00ff,...", for a cache already set up.
+ *
+ * @param spec The partition.
+ * @param numClasses The number of classes of service.
+ * @param cache Reference to the Cache to be partitioned.
+ * @param partition Reference to the WayPartition to configure.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int parsePartition(const std::string &spec, int numClasses, const Cache &cache, WayPartition &partition);
+
+/**
+ * Restricts the fills of a standalone cache to the ways of each access's
+ * class. A dynamic partition starts with the ways split evenly.
+ *
+ * @param partition Reference to the configured WayPartition.
+ * @param cache Reference to the Cache, which must not be filled yet.
+ */
+void partitionAttach(WayPartition &partition, Cache &cache);
+
+/**
+ * Makes a class the one the next access belongs to, feeds the access to its
+ * utility monitor and repartitions the cache when the interval is up.
+ *
+ * @param partition Reference to the attached WayPartition.
+ * @param cache Reference to the Cache.
+ * @param cls The class of the access.
+ * @param address The address accessed.
+ */
+void partitionSelect(WayPartition &partition, Cache &cache, int cls, uint64_t address);
+
+/**
+ * Prints a class's way mask and the blocks it occupies.
+ *
+ * @param partition Reference to the WayPartition.
+ * @param cls The class.
+ */
+void displayPartitionClass(const WayPartition &partition, int cls);
+
+#endif // PARTITION_H
@@ -0,0 +1,293 @@
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+
+#include "prefetch.h"
+#include "victim_cache.h"
+
+int parsePrefetcher(const std::string &spec, Prefetcher &prefetcher)
+{
+    std::stringstream stream(spec);
+    std::string kind;
+    std::getline(stream, kind, ':');
+    std::vector<long long> fields;
+    std::string field;
+    bool valid = kind == "next-line" || kind == "stride" || kind == "stream";
+    while (valid && std::getline(stream, field, ':'))
+    {
+        char *end;
+        long long value = std::strtoll(field.c_str(), &end, 10);
+        valid = !field.empty() && *end == '\0' && value >= 1 && value <= (1 << 20);
+        fields.push_back(value);
+    }
+    if (!valid || fields.size() > 2 || (!fields.empty() && fields[0] > PREFETCH_MAX_DEGREE))
+    {
+        std::cerr << "Invalid prefetcher " << spec << ", expected next-line, stride or stream[:degree[:distance]]"
+                  << " with a degree of 1 to " << PREFETCH_MAX_DEGREE << ". Exiting.\n";
+        return 1;
+    }
+    prefetcher.kind = kind == "stride" ? PrefetchKind::Stride : kind == "stream" ? PrefetchKind::Stream : PrefetchKind::NextLine;
+    prefetcher.degree = fields.size() >= 1 ? static_cast<int>(fields[0]) : 1;
+    prefetcher.distance = fields.size() == 2 ? static_cast<int>(fields[1]) : 1;
+    return 0;
+}
+
+static bool isPrefetched(const Prefetcher &prefetcher, const Cache &cache, int index, int way)
+{
+    return (prefetcher.prefetched[static_cast<size_t>(index) * cache.maskWords + (way >> 6)] >> (way & 63)) & 1;
+}
+
+static void setPrefetched(Prefetcher &prefetcher, const Cache &cache, int index, int way, bool value)
+{
+    uint64_t &word = prefetcher.prefetched[static_cast<size_t>(index) * cache.maskWords + (way >> 6)];
+    uint64_t bit = uint64_t(1) << (way & 63);
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+// forgets a block evicted by a prefetch fill, now that it is back; true if one was remembered
+static bool forgetEvicted(Prefetcher &prefetcher, const Cache &cache, int index, uint64_t address)
+{
+    uint64_t *evicted = prefetcher.evicted.data() + cache.slot(index, 0);
+    for (int way = 0; way < cache.numBlocks; way++)
+    {
+        if (evicted[way] == address + 1)
+        {
+            evicted[way] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// fetches one predicted block, unless it is already cached or no MSHR is free
+static void prefetchBlock(Prefetcher &prefetcher, Cache &cache, uint64_t block)
+{
+    uint64_t address = block << cache.offsetBits;
+    if ((address >> cache.offsetBits) != block)
+    {
+        return; // past the end of the address space
+    }
+    int index = calculateIndex(address, cache);
+    uint64_t tag = calculateTag(address, cache);
+    if (findBlock(tag, index, cache) >= 0)
+    {
+        return;
+    }
+    if (cache.victimCache && victimCacheHolds(*cache.victimCache, address))
+    {
+        return; // already on chip: a demand miss swaps it back, and a second copy would be written back twice
+    }
+    if (!chargePrefetch(cache, memoryCycles(cache.timing, cache.numBytes), address))
+    {
+        prefetcher.dropped++;
+        return;
+    }
+    uint64_t victim;
+    int way = cachePrefetchFill(cache, index, tag, victim);
+    setPrefetched(prefetcher, cache, index, way, true);
+    prefetcher.issued++;
+    forgetEvicted(prefetcher, cache, index, address);
+    if (victim != NO_VICTIM)
+    {
+        prefetcher.evicted[cache.slot(index, way)] = victim + 1;
+    }
+}
+
+// fetches degree blocks, the first `first` steps of `step` blocks away from block
+static void prefetchAhead(Prefetcher &prefetcher, Cache &cache, uint64_t block, int64_t step, int64_t first)
+{
+    for (int k = 0; k < prefetcher.degree; k++)
+    {
+        int64_t delta = step * (first + k);
+        if (delta < 0 ? static_cast<uint64_t>(-delta) > block : block + delta < block)
+        {
+            return; // would wrap around the address space
+        }
+        prefetchBlock(prefetcher, cache, block + delta);
+    }
+}
+
+static void trainStride(Prefetcher &prefetcher, Cache &cache, uint64_t address, uint64_t block)
+{
+    uint64_t region = address >> PREFETCH_REGION_BITS;
+    StrideEntry &entry = prefetcher.strides[region % PREFETCH_STRIDE_ENTRIES];
+    if (entry.region != region)
+    {
+        entry = StrideEntry();
+        entry.region = region;
+        entry.lastBlock = block;
+        return;
+    }
+    int64_t stride = static_cast<int64_t>(block - entry.lastBlock);
+    if (stride == 0)
+    {
+        return; // same block again
+    }
+    if (stride == entry.stride)
+    {
+        entry.confidence = std::min(entry.confidence + 1, 3);
+    }
+    else
+    {
+        entry.stride = stride;
+        entry.confidence = 0;
+    }
+    entry.lastBlock = block;
+    // prefetch once the stride has repeated
+    if (entry.confidence >= 1)
+    {
+        prefetchAhead(prefetcher, cache, block, stride, prefetcher.distance);
+    }
+}
+
+static void trainStream(Prefetcher &prefetcher, Cache &cache, uint64_t block)
+{
+    // the stream whose last miss is near this block, or else the least recently used entry for a new one
+    StreamEntry *stream = nullptr;
+    StreamEntry *oldest = &prefetcher.streams[0];
+    for (StreamEntry &entry : prefetcher.streams)
+    {
+        uint64_t gap = block > entry.lastBlock ? block - entry.lastBlock : entry.lastBlock - block;
+        if (entry.lastUse && gap <= PREFETCH_STREAM_WINDOW)
+        {
+            stream = &entry;
+            break;
+        }
+        if (entry.lastUse < oldest->lastUse)
+        {
+            oldest = &entry;
+        }
+    }
+    if (stream == nullptr)
+    {
+        oldest->lastBlock = block;
+        oldest->direction = 0;
+        oldest->lastUse = prefetcher.accesses;
+        return;
+    }
+    stream->lastUse = prefetcher.accesses;
+    if (block == stream->lastBlock)
+    {
+        return;
+    }
+    int direction = block > stream->lastBlock ? 1 : -1;
+    bool confirmed = stream->direction == direction;
+    stream->direction = direction;
+    stream->lastBlock = block;
+    if (confirmed)
+    {
+        prefetchAhead(prefetcher, cache, block, direction, prefetcher.distance);
+    }
+}
+
+// the access path of a cache with a prefetcher: the demand access, then training
+static void prefetchAccess(Cache &cache, char loadStore, uint64_t address)
+{
+    Prefetcher &prefetcher = *cache.prefetcher;
+    prefetcher.accesses++;
+    int index = calculateIndex(address, cache);
+    uint64_t tag = calculateTag(address, cache);
+    int hit = findBlock(tag, index, cache);
+
+    // misses and first hits to prefetched blocks trigger the next-line and stream prefetchers
+    bool trigger = hit < 0;
+    if (hit >= 0 && isPrefetched(prefetcher, cache, index, hit))
+    {
+        prefetcher.useful++;
+        setPrefetched(prefetcher, cache, index, hit, false);
+        trigger = true;
+    }
+    if (hit < 0 && forgetEvicted(prefetcher, cache, index, blockAddress(cache, index, tag)))
+    {
+        prefetcher.pollution++;
+    }
+
+    if (loadStore == 'l')
+    {
+        handleLoad(cache, index, tag, hit);
+    }
+    else
+    {
+        handleStore(cache, index, tag, hit);
+    }
+    if (hit < 0)
+    {
+        int way = findBlock(tag, index, cache);
+        if (way >= 0)
+        {
+            setPrefetched(prefetcher, cache, index, way, false); // a demand fill replaced the way
+        }
+    }
+
+    uint64_t block = address >> cache.offsetBits;
+    if (prefetcher.kind == PrefetchKind::Stride)
+    {
+        trainStride(prefetcher, cache, address, block);
+    }
+    else if (!trigger)
+    {
+        return;
+    }
+    else if (prefetcher.kind == PrefetchKind::Stream)
+    {
+        trainStream(prefetcher, cache, block);
+    }
+    else // next-line
+    {
+        prefetchAhead(prefetcher, cache, block, 1, prefetcher.distance);
+    }
+}
+
+static void prefetchBatch(Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i + BATCH_PREFETCH_DISTANCE < count)
+        {
+            cachePrefetchSet(cache, calculateIndex(addresses[i + BATCH_PREFETCH_DISTANCE], cache));
+        }
+        prefetchAccess(cache, loadStore[i], addresses[i]);
+    }
+}
+
+void prefetcherAttach(Prefetcher &prefetcher, Cache &cache)
+{
+    prefetcher.prefetched.assign(static_cast<size_t>(cache.numSets) * cache.maskWords, 0);
+    prefetcher.evicted.assign(static_cast<size_t>(cache.numSets) * cache.wayStride, 0);
+    prefetcher.strides.assign(PREFETCH_STRIDE_ENTRIES, StrideEntry());
+    prefetcher.streams.assign(PREFETCH_STREAMS, StreamEntry());
+    prefetcher.accesses = 0;
+    prefetcherClearStatistics(prefetcher);
+    cache.prefetcher = &prefetcher;
+    cache.simulate = prefetchAccess;
+    cache.simulateBatch = prefetchBatch;
+}
+
+void prefetcherClearStatistics(Prefetcher &prefetcher)
+{
+    prefetcher.issued = 0;
+    prefetcher.useful = 0;
+    prefetcher.dropped = 0;
+    prefetcher.pollution = 0;
+}
+
+// fraction, or 0 with nothing to divide by
+static double ratio(uint64_t part, uint64_t whole)
+{
+    return whole ? static_cast<double>(part) / whole : 0.0;
+}
+
+void displayPrefetchStatistics(const Prefetcher &prefetcher, const Cache &cache)
+{
+    uint64_t misses = cache.loadMisses + cache.storeMisses;
+    std::cout << "Prefetches issued: " << prefetcher.issued << std::endl;
+    std::cout << "Useful prefetches: " << prefetcher.useful << std::endl;
+    std::cout << "Prefetch accuracy: " << ratio(prefetcher.useful, prefetcher.issued) << std::endl;
+    std::cout << "Prefetch coverage: " << ratio(prefetcher.useful, prefetcher.useful + misses) << std::endl;
+    std::cout << "Prefetch pollution: " << prefetcher.pollution << std::endl;
+    if (cache.timing.mshrs)
+    {
+        std::cout << "Dropped prefetches: " << prefetcher.dropped << std::endl;
+    }
+}
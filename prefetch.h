@@ -0,0 +1,130 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+
+// HARDWARE PREFETCHERS
+//
+// A prefetcher watches the demand accesses of a standalone cache and fills the
+// blocks it predicts through the cache's replacement path, ahead of demand:
+// - next-line: on a miss, or the first hit to a prefetched block, fetches the
+//   blocks distance to distance + degree - 1 lines ahead;
+// - stride: a table of 4 KB regions remembers the last block and stride seen
+//   in each; once the same stride repeats, fetches degree blocks starting
+//   distance strides ahead;
+// - stream: tracks up to PREFETCH_STREAMS streams of misses moving through
+//   nearby blocks; once a stream shows a direction, each miss or prefetch hit
+//   on it fetches degree blocks starting distance lines ahead in that direction.
+// Attaching a prefetcher swaps the cache's access functions for ones that ask
+// it after every access; a cache without one runs the unchanged core.
+//
+// Prefetch fills count no accesses, hits or misses. A prefetched block is
+// useful when a demand access hits it before it is evicted; a demand miss on
+// a block that a prefetch evicted, before it came back, counts as pollution.
+// Each way remembers the last block a prefetch fill evicted from it, so the
+// pollution tracking is as large as the cache: that record ages out when a
+// later prefetch fill evicts from the same way.
+
+// regions the stride prefetcher trains within, and entries of its table
+static const int PREFETCH_REGION_BITS = 12;
+static const int PREFETCH_STRIDE_ENTRIES = 64;
+// concurrent streams tracked, and how many blocks from a stream's last miss still belong to it
+static const int PREFETCH_STREAMS = 16;
+static const int PREFETCH_STREAM_WINDOW = 16;
+// largest degree accepted on the command line
+static const int PREFETCH_MAX_DEGREE = 64;
+
+enum class PrefetchKind
+{
+    NextLine,
+    Stride,
+    Stream
+};
+
+/**
+ * Struct representing one region of the stride prefetcher's table.
+ */
+struct StrideEntry
+{
+    uint64_t region = UINT64_MAX; // Address >> PREFETCH_REGION_BITS, UINT64_MAX if unused
+    uint64_t lastBlock = 0;
+    int64_t stride = 0; // In blocks
+    int confidence = 0; // Times in a row the stride repeated, saturating at 3
+};
+
+/**
+ * Struct representing one stream of the stream prefetcher.
+ */
+struct StreamEntry
+{
+    uint64_t lastBlock = 0;
+    int direction = 0;   // +1 ascending, -1 descending, 0 not yet known
+    uint64_t lastUse = 0; // Access the stream was last advanced at, 0 if unused
+};
+
+/**
+ * Struct representing a prefetcher and its statistics.
+ */
+struct Prefetcher
+{
+    // CONFIGURATION
+    PrefetchKind kind = PrefetchKind::NextLine;
+    int degree = 1;   // Blocks fetched per trigger
+    int distance = 1; // How far ahead of the trigger the first one is, in lines or strides
+
+    // STATE
+    std::vector<uint64_t> prefetched; // Per way, in the cache's valid mask layout: a prefetch filled it and no demand access has hit it yet
+    std::vector<uint64_t> evicted;    // Per slot: address + 1 of the block a prefetch fill last evicted from it, 0 once it is back
+    std::vector<StrideEntry> strides;
+    std::vector<StreamEntry> streams;
+    uint64_t accesses = 0; // Demand accesses seen, the stream replacement clock
+
+    // STATISTICS
+    uint64_t issued = 0;    // Prefetch fills
+    uint64_t useful = 0;    // Prefetched blocks a demand access hit
+    uint64_t dropped = 0;   // Prefetches not issued because every MSHR was busy
+    uint64_t pollution = 0; // Demand misses on blocks a prefetch evicted
+};
+
+/**
+ * Parses a prefetcher specification "kind[:degree[:distance]]", kind being
+ * next-line, stride or stream; degree and distance default to 1.
+ *
+ * @param spec The specification.
+ * @param prefetcher Reference to the Prefetcher to configure.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int parsePrefetcher(const std::string &spec, Prefetcher &prefetcher);
+
+/**
+ * Attaches a configured prefetcher to a standalone cache, clearing its state,
+ * so that every later cacheSimulator and cacheSimulateBatch call trains it.
+ *
+ * @param prefetcher Reference to the Prefetcher, which must outlive the cache's use.
+ * @param cache Reference to the Cache, already set up by cacheSetUp.
+ */
+void prefetcherAttach(Prefetcher &prefetcher, Cache &cache);
+
+/**
+ * Clears a prefetcher's statistics, keeping what it has learned.
+ *
+ * @param prefetcher Reference to the Prefetcher.
+ */
+void prefetcherClearStatistics(Prefetcher &prefetcher);
+
+/**
+ * Displays a prefetcher's statistics after displayStatistics: prefetches issued
+ * and useful, accuracy (useful / issued), coverage (useful / (useful + demand
+ * misses)) and pollution.
+ *
+ * @param prefetcher Reference to the Prefetcher.
+ * @param cache Reference to the Cache it was attached to.
+ */
+void displayPrefetchStatistics(const Prefetcher &prefetcher, const Cache &cache);
+
+#endif // PREFETCH_H
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "sampling.h"
+
+// 95% two-sided normal quantile
+static const double CONFIDENCE_Z = 1.96;
+
+int parseSampleWindows(const std::string &spec, Sampler &sampler)
+{
+    std::vector<long long> fields;
+    std::stringstream stream(spec);
+    std::string field;
+    while (std::getline(stream, field, ':'))
+    {
+        char *end;
+        long long value = std::strtoll(field.c_str(), &end, 10);
+        if (field.empty() || *end != '\0' || value < 0)
+        {
+            fields.clear();
+            break;
+        }
+        fields.push_back(value);
+    }
+    if (fields.size() < 2 || fields.size() > 3 || fields[0] < 1 ||
+        fields[0] + (fields.size() == 3 ? fields[2] : 0) > fields[1])
+    {
+        std::cerr << "Invalid sample windows " << spec << ", expected window:period[:warmup] with window + warmup <= period. Exiting.\n";
+        return 1;
+    }
+    sampler.window = fields[0];
+    sampler.period = fields[1];
+    sampler.warmup = fields.size() == 3 ? fields[2] : 0;
+    return 0;
+}
+
+// spreads consecutive set indices over the whole range before choosing among them
+static uint64_t mixIndex(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+int samplerSetUp(Sampler &sampler, const Cache &cache)
+{
+    if (sampler.setRatio < 1 || sampler.setRatio > cache.numSets)
+    {
+        std::cerr << "Invalid set sampling ratio, expected 1 to the number of sets. Exiting.\n";
+        return 1;
+    }
+    // the sets with the smallest hashes, numSets / setRatio of them
+    std::vector<int> order(cache.numSets);
+    for (int index = 0; index < cache.numSets; index++)
+    {
+        order[index] = index;
+    }
+    std::sort(order.begin(), order.end(), [](int a, int b)
+              { return mixIndex(a) < mixIndex(b); });
+    sampler.numSampledSets = cache.numSets / sampler.setRatio;
+    sampler.sampledSets.assign(cache.numSets, 0);
+    for (int i = 0; i < sampler.numSampledSets; i++)
+    {
+        sampler.sampledSets[order[i]] = 1;
+    }
+
+    sampler.position = sampler.loads = sampler.stores = 0;
+    sampler.measuredLoads = sampler.measuredStores = 0;
+    sampler.measuredLoadHits = sampler.measuredStoreHits = 0;
+    sampler.measuredCycles = 0;
+    // samples are the sets when sets are sampled, since the spread between sets dominates
+    bool bySet = sampler.setRatio > 1 || sampler.window == 0;
+    sampler.sampleAccesses.assign(bySet ? cache.numSets : 0, 0);
+    sampler.sampleMisses.assign(bySet ? cache.numSets : 0, 0);
+    return 0;
+}
+
+void samplerSimulate(Sampler &sampler, Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count)
+{
+    for (size_t i = 0; i < count; i++, sampler.position++)
+    {
+        bool store = loadStore[i] == 's';
+        if (store)
+        {
+            sampler.stores++;
+        }
+        else
+        {
+            sampler.loads++;
+        }
+
+        // window sampling: warmup, then the measured window, then skip to the next period
+        bool measured = true;
+        size_t sample = 0;
+        if (sampler.window)
+        {
+            uint64_t phase = sampler.position % sampler.period;
+            if (phase >= sampler.warmup + sampler.window)
+            {
+                continue;
+            }
+            measured = phase >= sampler.warmup;
+            sample = sampler.position / sampler.period;
+        }
+
+        // set sampling: drop accesses to unsampled sets before they reach the cache
+        int index = calculateIndex(addresses[i], cache);
+        if (!sampler.sampledSets[index])
+        {
+            continue;
+        }
+        if (!measured)
+        {
+            cacheSimulator(cache, loadStore[i], addresses[i]);
+            continue;
+        }
+
+        uint64_t misses = cache.loadMisses + cache.storeMisses;
+        uint64_t cycles = cache.totalCycles;
+        cacheSimulator(cache, loadStore[i], addresses[i]);
+        bool miss = cache.loadMisses + cache.storeMisses != misses;
+        sampler.measuredCycles += cache.totalCycles - cycles;
+        if (store)
+        {
+            sampler.measuredStores++;
+            sampler.measuredStoreHits += !miss;
+        }
+        else
+        {
+            sampler.measuredLoads++;
+            sampler.measuredLoadHits += !miss;
+        }
+
+        if (sampler.window && sampler.setRatio == 1)
+        {
+            if (sample >= sampler.sampleAccesses.size())
+            {
+                sampler.sampleAccesses.resize(sample + 1, 0);
+                sampler.sampleMisses.resize(sample + 1, 0);
+            }
+        }
+        else
+        {
+            sample = index;
+        }
+        sampler.sampleAccesses[sample]++;
+        sampler.sampleMisses[sample] += miss;
+    }
+}
+
+// scales a measured count by total / measured, rounding to the nearest count
+static uint64_t scaleCount(uint64_t count, uint64_t total, uint64_t measured)
+{
+    if (measured == 0)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::llround(static_cast<double>(count) * total / measured));
+}
+
+void displaySampled(Sampler &sampler)
+{
+    uint64_t loadHits = scaleCount(sampler.measuredLoadHits, sampler.loads, sampler.measuredLoads);
+    uint64_t storeHits = scaleCount(sampler.measuredStoreHits, sampler.stores, sampler.measuredStores);
+    uint64_t measured = sampler.measuredLoads + sampler.measuredStores;
+    std::cout << "Total loads: " << sampler.loads << std::endl;
+    std::cout << "Total stores: " << sampler.stores << std::endl;
+    std::cout << "Load hits: " << loadHits << std::endl;
+    std::cout << "Load misses: " << sampler.loads - loadHits << std::endl;
+    std::cout << "Store hits: " << storeHits << std::endl;
+    std::cout << "Store misses: " << sampler.stores - storeHits << std::endl;
+    std::cout << "Total cycles: " << scaleCount(sampler.measuredCycles, sampler.position, measured) << std::endl;
+    std::cout << "Sampled accesses: " << measured << " of " << sampler.position << std::endl;
+
+    // ratio estimator over the samples, with the finite population correction
+    // for the fraction of sets or of the trace that was measured
+    bool byWindow = sampler.window && sampler.setRatio == 1;
+    size_t samples = 0;
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+    for (size_t i = 0; i < sampler.sampleAccesses.size(); i++)
+    {
+        if (byWindow || sampler.sampledSets[i])
+        {
+            samples++;
+            accesses += sampler.sampleAccesses[i];
+            misses += sampler.sampleMisses[i];
+        }
+    }
+    if (samples < 2 || accesses == 0)
+    {
+        std::cout << "Miss ratio: " << (accesses ? static_cast<double>(misses) / accesses : 0.0)
+                  << " (too few samples for a confidence interval)" << std::endl;
+        return;
+    }
+    double ratio = static_cast<double>(misses) / accesses;
+    double sumSquares = 0;
+    for (size_t i = 0; i < sampler.sampleAccesses.size(); i++)
+    {
+        if (byWindow || sampler.sampledSets[i])
+        {
+            double residual = sampler.sampleMisses[i] - ratio * sampler.sampleAccesses[i];
+            sumSquares += residual * residual;
+        }
+    }
+    double meanAccesses = static_cast<double>(accesses) / samples;
+    double fraction = byWindow ? static_cast<double>(sampler.window) / sampler.period
+                                     : static_cast<double>(sampler.numSampledSets) / sampler.sampledSets.size();
+    double variance = (1 - fraction) * sumSquares / (samples - 1) / (samples * meanAccesses * meanAccesses);
+    std::cout << "Miss ratio: " << ratio << " +/- " << CONFIDENCE_Z * std::sqrt(variance)
+              << " (95% confidence, " << samples << " samples)" << std::endl;
+}
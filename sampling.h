@@ -0,0 +1,92 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+
+// SAMPLED SIMULATION
+//
+// Two ways of simulating part of a trace and estimating the whole:
+// - set sampling keeps one set in setRatio, chosen by a hash of the index;
+//   accesses to other sets are dropped after decoding, before findBlock, and
+//   never touch the cache;
+// - window sampling simulates warmup + window accesses out of every period:
+//   the warmup accesses only bring the cache state up to date, the window
+//   accesses are measured, and the rest of the period is skipped.
+// Both can be combined. Loads and stores are counted exactly; hits, misses and
+// cycles are scaled up from the measured accesses. The miss ratio comes with a
+// 95% confidence interval from the spread between samples: the sampled sets,
+// or the windows when only window sampling is on.
+
+/**
+ * Struct representing a sampled run and its measurements.
+ */
+struct Sampler
+{
+    // CONFIGURATION
+    int setRatio = 1;    // Simulate one set in setRatio (1: every set)
+    uint64_t window = 0; // Measured accesses per period (0: no window sampling)
+    uint64_t period = 0; // Accesses per sampling period
+    uint64_t warmup = 0; // Unmeasured accesses simulated before each window
+
+    std::vector<uint8_t> sampledSets; // Per set: the set is simulated
+    int numSampledSets = 0;
+
+    // EXACT TRACE COUNTS
+    uint64_t position = 0; // Accesses seen
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+
+    // MEASURED ACCESSES
+    uint64_t measuredLoads = 0;
+    uint64_t measuredStores = 0;
+    uint64_t measuredLoadHits = 0;
+    uint64_t measuredStoreHits = 0;
+    uint64_t measuredCycles = 0;
+    std::vector<uint64_t> sampleAccesses; // Per sample (set or window): measured accesses
+    std::vector<uint64_t> sampleMisses;   // Per sample: measured misses
+};
+
+/**
+ * Parses a window sampling specification "window:period[:warmup]".
+ *
+ * @param spec The specification.
+ * @param sampler Reference to the Sampler to configure.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int parseSampleWindows(const std::string &spec, Sampler &sampler);
+
+/**
+ * Chooses the sampled sets of a cache and clears the measurements.
+ *
+ * @param sampler Reference to the configured Sampler.
+ * @param cache The cache that will be simulated.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int samplerSetUp(Sampler &sampler, const Cache &cache);
+
+/**
+ * Simulates the sampled part of a run of accesses.
+ *
+ * @param sampler Reference to the Sampler.
+ * @param cache Reference to the Cache being simulated.
+ * @param loadStore The operation of each access.
+ * @param addresses The address of each access.
+ * @param count The number of accesses.
+ */
+void samplerSimulate(Sampler &sampler, Cache &cache, const char *loadStore, const uint64_t *addresses, size_t count);
+
+/**
+ * Displays the estimated statistics in the displayStatistics format, followed
+ * by the fraction of accesses measured and the miss ratio's confidence interval.
+ *
+ * @param sampler Reference to the Sampler of a finished run.
+ */
+void displaySampled(Sampler &sampler);
+
+#endif // SAMPLING_H
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include "stack_distance.h"
+
+// marks a local time whose block has been accessed again since
+static const uint64_t STACK_NO_BLOCK = UINT64_MAX;
+// initial number of local times tracked per set
+static const uint32_t STACK_INITIAL_CAPACITY = 16;
+
+static void fenwickAdd(std::vector<uint32_t> &tree, uint32_t i, int delta)
+{
+    for (; i < tree.size(); i += i & (~i + 1))
+    {
+        tree[i] += delta;
+    }
+}
+
+static uint32_t fenwickPrefix(const std::vector<uint32_t> &tree, uint32_t i)
+{
+    uint32_t sum = 0;
+    for (; i > 0; i -= i & (~i + 1))
+    {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+// renumbers the live blocks of a set from 1 once its local clock runs out of room;
+// blocks deeper than maxBlocks in the stack can only ever miss, so they are dropped
+static void stackCompact(StackDistance &analysis, StackSet &set)
+{
+    std::vector<uint64_t> blocks;
+    blocks.reserve(set.live);
+    for (uint32_t t = 1; t < set.clock; t++)
+    {
+        if (set.blockAt[t] != STACK_NO_BLOCK)
+        {
+            blocks.push_back(set.blockAt[t]);
+        }
+    }
+
+    size_t keep = std::min<size_t>(blocks.size(), analysis.maxBlocks);
+    size_t dropped = blocks.size() - keep;
+    for (size_t i = 0; i < dropped; i++)
+    {
+        analysis.lastAccess.erase(blocks[i]);
+    }
+
+    size_t capacity = set.tree.size() - 1;
+    while (capacity < 2 * keep)
+    {
+        capacity *= 2;
+    }
+    set.tree.assign(capacity + 1, 0);
+    set.blockAt.assign(capacity + 1, STACK_NO_BLOCK);
+
+    for (size_t i = 0; i < keep; i++)
+    {
+        uint32_t t = i + 1;
+        uint64_t block = blocks[dropped + i];
+        set.blockAt[t] = block;
+        analysis.lastAccess[block] = t;
+        set.tree[t] = 1;
+    }
+    // linear-time Fenwick construction
+    for (uint32_t i = 1; i <= capacity; i++)
+    {
+        uint32_t parent = i + (i & (~i + 1));
+        if (parent <= capacity)
+        {
+            set.tree[parent] += set.tree[i];
+        }
+    }
+
+    set.clock = keep + 1;
+    set.live = keep;
+}
+
+void stackSetUp(StackDistance &analysis, int numSets, int numBytes, int maxBlocks)
+{
+    analysis.numSets = numSets;
+    analysis.numBytes = numBytes;
+    analysis.maxBlocks = maxBlocks;
+    analysis.offsetBits = log2PowTwo(numBytes);
+    analysis.indexBits = log2PowTwo(numSets);
+
+    analysis.sets.assign(numSets, StackSet());
+    for (StackSet &set : analysis.sets)
+    {
+        set.tree.assign(STACK_INITIAL_CAPACITY + 1, 0);
+        set.blockAt.assign(STACK_INITIAL_CAPACITY + 1, STACK_NO_BLOCK);
+    }
+    analysis.lastAccess.clear();
+    analysis.loadDistance.assign(maxBlocks, 0);
+    analysis.storeDistance.assign(maxBlocks, 0);
+    analysis.loadCount = 0;
+    analysis.storeCount = 0;
+}
+
+void stackAccess(StackDistance &analysis, char loadStore, uint64_t address)
+{
+    uint64_t block = address >> analysis.offsetBits;
+    StackSet &set = analysis.sets[block & ((1u << analysis.indexBits) - 1)];
+    if (set.clock >= set.tree.size())
+    {
+        stackCompact(analysis, set);
+    }
+
+    // distance = distinct blocks of this set touched since the last access to this block
+    size_t distance = analysis.maxBlocks; // first touch: misses at every size
+    auto found = analysis.lastAccess.find(block);
+    if (found != analysis.lastAccess.end())
+    {
+        uint32_t previous = found->second;
+        distance = set.live - fenwickPrefix(set.tree, previous);
+        fenwickAdd(set.tree, previous, -1);
+        set.blockAt[previous] = STACK_NO_BLOCK;
+        set.live--;
+        found->second = set.clock;
+    }
+    else
+    {
+        analysis.lastAccess.emplace(block, set.clock);
+    }
+
+    set.blockAt[set.clock] = block;
+    fenwickAdd(set.tree, set.clock, 1);
+    set.live++;
+    set.clock++;
+
+    if (loadStore == 'l')
+    {
+        analysis.loadCount++;
+        if (distance < analysis.loadDistance.size())
+        {
+            analysis.loadDistance[distance]++;
+        }
+    }
+    else
+    {
+        analysis.storeCount++;
+        if (distance < analysis.storeDistance.size())
+        {
+            analysis.storeDistance[distance]++;
+        }
+    }
+}
+
+void runStackDistance(StackDistance &analysis, TraceReader &reader, std::vector<Cache> &validation)
+{
+    TraceBatch batch;
+    while (traceNextBatch(reader, batch) > 0)
+    {
+        for (size_t i = 0; i < batch.count; i++)
+        {
+            stackAccess(analysis, batch.loadStore[i], batch.addresses[i]);
+        }
+        for (Cache &cache : validation)
+        {
+            cacheSimulateBatch(cache, batch.loadStore.data(), batch.addresses.data(), batch.count);
+        }
+    }
+}
+
+void displayMissRatioCurve(StackDistance &analysis)
+{
+    std::cout << "blocks load_hits load_misses store_hits store_misses miss_ratio" << std::endl;
+
+    uint64_t loadHits = 0;
+    uint64_t storeHits = 0;
+    int distance = 0;
+    for (int blocks = 1; blocks <= analysis.maxBlocks; blocks *= 2)
+    {
+        // a cache with this many blocks per set hits every distance below it
+        for (; distance < blocks; distance++)
+        {
+            loadHits += analysis.loadDistance[distance];
+            storeHits += analysis.storeDistance[distance];
+        }
+        uint64_t total = analysis.loadCount + analysis.storeCount;
+        uint64_t misses = total - loadHits - storeHits;
+        double missRatio = total ? static_cast<double>(misses) / total : 0.0;
+
+        std::cout << blocks << ' ' << loadHits << ' ' << analysis.loadCount - loadHits << ' '
+                  << storeHits << ' ' << analysis.storeCount - storeHits << ' '
+                  << std::fixed << std::setprecision(6) << missRatio << std::endl;
+    }
+}
+
+int validateStackDistance(StackDistance &analysis, std::vector<Cache> &validation)
+{
+    int status = 0;
+    uint64_t loadHits = 0;
+    uint64_t storeHits = 0;
+    int distance = 0;
+    for (Cache &cache : validation)
+    {
+        for (; distance < cache.numBlocks; distance++)
+        {
+            loadHits += analysis.loadDistance[distance];
+            storeHits += analysis.storeDistance[distance];
+        }
+        if (static_cast<uint64_t>(cache.loadHits) != loadHits || static_cast<uint64_t>(cache.storeHits) != storeHits)
+        {
+            std::cerr << "Stack distance mismatch at " << cache.numBlocks << " blocks: simulated "
+                      << cache.loadHits << " load hits, " << cache.storeHits << " store hits; predicted "
+                      << loadHits << ", " << storeHits << ".\n";
+            status = 1;
+        }
+    }
+    if (status == 0)
+    {
+        std::cerr << "Stack distance validated against " << validation.size() << " simulated caches.\n";
+    }
+    return status;
+}
@@ -0,0 +1,98 @@
+#ifndef STACKDISTANCE_H
+#define STACKDISTANCE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "cache_simulator.h"
+#include "trace_reader.h"
+
+// STRUCTS FOR SINGLE-PASS LRU STACK DISTANCE ANALYSIS
+
+/**
+ * Struct representing the LRU stack of one cache set.
+ * Each resident block is marked in a Fenwick tree at the per-set time of
+ * its most recent access, so the stack distance of a re-reference is the
+ * number of marks after the block's previous access.
+ */
+struct StackSet
+{
+    std::vector<uint32_t> tree;    // Fenwick tree over local access times (1-based)
+    std::vector<uint64_t> blockAt; // Block accessed at each local time
+    uint32_t clock = 1;            // Next local access time
+    uint32_t live = 0;             // Number of marked times (distinct blocks tracked)
+};
+
+/**
+ * Struct representing a stack distance analysis for a fixed number of sets and block size.
+ * One pass yields the hits and misses of an LRU write-allocate cache of every
+ * associativity up to maxBlocks.
+ */
+struct StackDistance
+{
+    // CACHE GEOMETRY
+    int numSets;
+    int numBytes;  // block size
+    int maxBlocks; // Largest associativity of interest
+    int offsetBits;
+    int indexBits;
+
+    // STACK STATE
+    std::vector<StackSet> sets;
+    std::unordered_map<uint64_t, uint32_t> lastAccess; // block number -> local time of its last access
+
+    // HISTOGRAMS: distance d hits in every cache with more than d blocks per set
+    std::vector<uint64_t> loadDistance;
+    std::vector<uint64_t> storeDistance;
+    uint64_t loadCount = 0;
+    uint64_t storeCount = 0;
+};
+
+/**
+ * Sets up a stack distance analysis.
+ *
+ * @param analysis Reference to the StackDistance to initialize.
+ * @param numSets The number of sets in the cache (a power of 2).
+ * @param numBytes The size of each block in bytes (a power of 2).
+ * @param maxBlocks The largest set size to report (a power of 2).
+ */
+void stackSetUp(StackDistance &analysis, int numSets, int numBytes, int maxBlocks);
+
+/**
+ * Records one access in the stack distance analysis.
+ *
+ * @param analysis Reference to the StackDistance being updated.
+ * @param loadStore A character indicating the operation: 'l' for load, 's' for store.
+ * @param address The memory address being accessed.
+ */
+void stackAccess(StackDistance &analysis, char loadStore, uint64_t address);
+
+/**
+ * Runs a stack distance analysis over a trace, optionally simulating the
+ * equivalent LRU caches alongside it for validation.
+ *
+ * @param analysis Reference to the StackDistance being updated.
+ * @param reader Reference to an open TraceReader.
+ * @param validation Caches simulated on the same records (may be empty).
+ */
+void runStackDistance(StackDistance &analysis, TraceReader &reader, std::vector<Cache> &validation);
+
+/**
+ * Displays the miss ratio curve for every power-of-two set size up to maxBlocks.
+ *
+ * @param analysis Reference to the completed StackDistance.
+ */
+void displayMissRatioCurve(StackDistance &analysis);
+
+/**
+ * Compares the analysis with caches simulated by cacheSimulator.
+ * The caches must be LRU write-allocate caches with one power-of-two set size each, starting at 1.
+ *
+ * @param analysis Reference to the completed StackDistance.
+ * @param validation The simulated caches.
+ * @return int 0 if every hit and miss count matches, 1 otherwise.
+ */
+int validateStackDistance(StackDistance &analysis, std::vector<Cache> &validation);
+
+#endif // STACKDISTANCE_H
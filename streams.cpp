@@ -0,0 +1,283 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+#include "streams.h"
+#include "timing.h"
+
+int parseInterleave(const std::string &spec, int numStreams, StreamReplay &replay)
+{
+    replay.weights.assign(numStreams, 1);
+    if (spec == "round-robin")
+    {
+        replay.policy = InterleavePolicy::RoundRobin;
+        return 0;
+    }
+    if (spec == "time")
+    {
+        replay.policy = InterleavePolicy::Time;
+        return 0;
+    }
+    if (spec.compare(0, 9, "weighted:") != 0)
+    {
+        std::cerr << "Invalid interleaving " << spec << ", expected round-robin, time or weighted:w1,w2,... Exiting.\n";
+        return 1;
+    }
+
+    replay.policy = InterleavePolicy::Weighted;
+    std::stringstream stream(spec.substr(9));
+    std::string field;
+    int count = 0;
+    while (std::getline(stream, field, ','))
+    {
+        char *end;
+        long weight = std::strtol(field.c_str(), &end, 10);
+        if (field.empty() || *end != '\0' || weight < 1 || weight > 1000000 || count == numStreams)
+        {
+            std::cerr << "Invalid weights " << spec << ", expected one weight from 1 to 1000000 per trace. Exiting.\n";
+            return 1;
+        }
+        replay.weights[count++] = static_cast<int>(weight);
+    }
+    if (count != numStreams)
+    {
+        std::cerr << "Invalid weights " << spec << ", expected one weight from 1 to 1000000 per trace. Exiting.\n";
+        return 1;
+    }
+    return 0;
+}
+
+// reader thread: decodes batches into the ring while the simulation has room for them
+static void readStream(Stream &stream)
+{
+    size_t tail = 0;
+    while (true)
+    {
+        while (tail - stream.head.load(std::memory_order_acquire) == STREAM_QUEUE_BATCHES)
+        {
+            std::this_thread::yield();
+        }
+        if (traceNextBatch(stream.reader, stream.slots[tail % STREAM_QUEUE_BATCHES]) == 0)
+        {
+            break;
+        }
+        stream.tail.store(++tail, std::memory_order_release);
+    }
+    stream.done.store(true, std::memory_order_release);
+}
+
+int streamsStart(StreamReplay &replay, const std::vector<std::string> &paths)
+{
+    if (paths.empty() || paths.size() > static_cast<size_t>(STREAMS_MAX) ||
+        std::count(paths.begin(), paths.end(), "-") > 1)
+    {
+        std::cerr << "Invalid traces, expected 1 to " << STREAMS_MAX << " of them, at most one of them -. Exiting.\n";
+        return 1;
+    }
+
+    // every trace is opened before any thread starts, so a bad path stops nothing midway
+    for (const std::string &path : paths)
+    {
+        std::unique_ptr<Stream> stream(new Stream());
+        stream->path = path;
+        if (traceOpen(stream->reader, path == "-" ? nullptr : path.c_str()) == 1)
+        {
+            for (std::unique_ptr<Stream> &opened : replay.streams)
+            {
+                traceClose(opened->reader);
+            }
+            replay.streams.clear();
+            return 1;
+        }
+        stream->slots.assign(STREAM_QUEUE_BATCHES, TraceBatch());
+        replay.streams.push_back(std::move(stream));
+    }
+    if (replay.weights.size() != paths.size())
+    {
+        replay.weights.assign(paths.size(), 1);
+    }
+    replay.owner.assign(static_cast<size_t>(replay.cache.numSets) * replay.cache.wayStride, 0);
+    for (std::unique_ptr<Stream> &stream : replay.streams)
+    {
+        stream->thread = std::thread(readStream, std::ref(*stream));
+    }
+    return 0;
+}
+
+// simulates one access of a stream and charges it to the stream
+static void streamAccess(StreamReplay &replay, int s, char loadStore, uint64_t address)
+{
+    Cache &cache = replay.cache;
+    StreamStats &stats = replay.streams[s]->stats;
+    if (cache.partition)
+    {
+        partitionSelect(replay.partition, cache, s, address);
+    }
+    int index = calculateIndex(address, cache);
+    int validWays = cacheValidWays(cache, index);
+    uint64_t misses = cache.loadMisses + cache.storeMisses;
+    uint64_t cycles = cache.totalCycles;
+    cache.simulate(cache, loadStore, address);
+    stats.cycles += cache.totalCycles - cycles;
+
+    bool miss = cache.loadMisses + cache.storeMisses != misses;
+    if (loadStore == 'l')
+    {
+        stats.loadCount++;
+        (miss ? stats.loadMisses : stats.loadHits)++;
+    }
+    else
+    {
+        stats.storeCount++;
+        (miss ? stats.storeMisses : stats.storeHits)++;
+    }
+    if (!miss)
+    {
+        return;
+    }
+
+    int way = findBlock(calculateTag(address, cache), index, cache);
+    if (way < 0)
+    {
+        return; // a store that does not allocate
+    }
+    // the block lands in the way of the one it evicted; under a partition that can happen while
+    // other ways of the set are invalid, so the valid ways not growing is what shows an eviction
+    uint8_t &owner = replay.owner[cache.slot(index, way)];
+    if (cacheValidWays(cache, index) == validWays)
+    {
+        stats.evictions++;
+        if (owner != s)
+        {
+            stats.crossEvictions++;
+            replay.streams[owner]->stats.evictedByOthers++;
+        }
+    }
+    owner = static_cast<uint8_t>(s);
+}
+
+// waits for the reader to publish the batch at head; false once the stream has ended
+static bool nextBatch(Stream &stream)
+{
+    size_t head = stream.head.load(std::memory_order_relaxed);
+    while (stream.tail.load(std::memory_order_acquire) == head)
+    {
+        if (stream.done.load(std::memory_order_acquire))
+        {
+            // the last batch may have been published just before done
+            return stream.tail.load(std::memory_order_acquire) != head;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// runs up to the given number of accesses of a stream, marking it finished at its end
+static void runTurn(StreamReplay &replay, int s, uint64_t accesses)
+{
+    Stream &stream = *replay.streams[s];
+    Cache &cache = replay.cache;
+    while (accesses > 0)
+    {
+        if (!nextBatch(stream))
+        {
+            stream.finished = true;
+            return;
+        }
+        size_t head = stream.head.load(std::memory_order_relaxed);
+        const TraceBatch &batch = stream.slots[head % STREAM_QUEUE_BATCHES];
+        size_t end = batch.count - stream.position < accesses ? batch.count : stream.position + accesses;
+        for (size_t i = stream.position; i < end; i++)
+        {
+            if (i + BATCH_PREFETCH_DISTANCE < end)
+            {
+                cachePrefetchSet(cache, calculateIndex(batch.addresses[i + BATCH_PREFETCH_DISTANCE], cache));
+            }
+            streamAccess(replay, s, batch.loadStore[i], batch.addresses[i]);
+        }
+        accesses -= end - stream.position;
+        stream.position = end;
+        if (stream.position == batch.count)
+        {
+            stream.position = 0;
+            stream.head.store(head + 1, std::memory_order_release); // hands the slot back to the reader
+        }
+    }
+}
+
+void runStreams(StreamReplay &replay)
+{
+    int numStreams = static_cast<int>(replay.streams.size());
+    int live = numStreams;
+    while (live > 0)
+    {
+        if (replay.policy == InterleavePolicy::Time)
+        {
+            // the stream whose clock is furthest behind, the first one on a tie
+            int next = -1;
+            for (int s = 0; s < numStreams; s++)
+            {
+                if (!replay.streams[s]->finished &&
+                    (next < 0 || replay.streams[s]->stats.cycles < replay.streams[next]->stats.cycles))
+                {
+                    next = s;
+                }
+            }
+            runTurn(replay, next, replay.quantum);
+            live -= replay.streams[next]->finished;
+            continue;
+        }
+        for (int s = 0; s < numStreams; s++)
+        {
+            if (!replay.streams[s]->finished)
+            {
+                runTurn(replay, s, replay.quantum * replay.weights[s]);
+                live -= replay.streams[s]->finished;
+            }
+        }
+    }
+    timingDrain(replay.cache);
+
+    for (std::unique_ptr<Stream> &stream : replay.streams)
+    {
+        stream->thread.join();
+        traceClose(stream->reader);
+    }
+}
+
+void displayStreams(StreamReplay &replay)
+{
+    for (size_t s = 0; s < replay.streams.size(); s++)
+    {
+        const Stream &stream = *replay.streams[s];
+        const StreamStats &stats = stream.stats;
+        std::cout << "Stream " << s << " (" << stream.path << "):" << std::endl;
+        std::cout << "Total loads: " << stats.loadCount << std::endl;
+        std::cout << "Total stores: " << stats.storeCount << std::endl;
+        std::cout << "Load hits: " << stats.loadHits << std::endl;
+        std::cout << "Load misses: " << stats.loadMisses << std::endl;
+        std::cout << "Store hits: " << stats.storeHits << std::endl;
+        std::cout << "Store misses: " << stats.storeMisses << std::endl;
+        std::cout << "Total cycles: " << stats.cycles << std::endl;
+        std::cout << "Evictions: " << stats.evictions << std::endl;
+        std::cout << "Cross-stream evictions: " << stats.crossEvictions << std::endl;
+        std::cout << "Evicted by other streams: " << stats.evictedByOthers << std::endl;
+        if (replay.cache.partition)
+        {
+            uint64_t accesses = stats.loadCount + stats.storeCount;
+            double missRate = accesses ? static_cast<double>(stats.loadMisses + stats.storeMisses) / accesses : 0.0;
+            displayPartitionClass(replay.partition, static_cast<int>(s));
+            std::cout << "Miss rate: " << std::fixed << std::setprecision(6) << missRate << std::defaultfloat << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Shared:" << std::endl;
+    displayStatistics(replay.cache);
+    std::cout << "Write-backs: " << replay.cache.writeBacks << std::endl;
+    if (replay.cache.partition && replay.partition.dynamic)
+    {
+        std::cout << "Repartitions: " << replay.partition.repartitions << std::endl;
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef STREAMS_H
+#define STREAMS_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cache_simulator.h"
+#include "partition.h"
+#include "trace_reader.h"
+
+// MULTI-STREAM REPLAY
+//
+// Several traces, one per process, share one cache. Each trace is decoded on
+// its own reader thread into a lock-free single-producer single-consumer ring
+// of batches, and the simulating thread interleaves the streams:
+// - round-robin: quantum accesses of each stream in turn;
+// - weighted: weight x quantum accesses of each stream in turn;
+// - time: the next quantum of the stream whose clock is furthest behind. The
+//   traces carry no timestamps, so a stream's clock is the cycles its own
+//   accesses were charged: a stream that misses more runs slower and issues
+//   fewer of the accesses in any window.
+// A stream that ends drops out; the others carry on without it.
+//
+// Every block remembers the stream that brought it in. A miss that allocates
+// in a full set evicts a block, counted against the stream missing and, when
+// the block was brought in by another stream, as a cross-stream eviction of
+// that stream's block.
+//
+// The cache can also be partitioned (see partition.h), each stream its own
+// class of service.
+
+// most streams replayed at once
+static const int STREAMS_MAX = 64;
+// batches a reader may decode ahead of the simulation
+static const size_t STREAM_QUEUE_BATCHES = 8;
+
+enum class InterleavePolicy
+{
+    RoundRobin,
+    Weighted,
+    Time
+};
+
+/**
+ * Struct representing the counters of one stream on the shared cache.
+ */
+struct StreamStats
+{
+    uint64_t loadCount = 0;
+    uint64_t storeCount = 0;
+    uint64_t loadHits = 0;
+    uint64_t loadMisses = 0;
+    uint64_t storeHits = 0;
+    uint64_t storeMisses = 0;
+    uint64_t cycles = 0;          // Cycles charged to the stream's accesses, its clock
+    uint64_t evictions = 0;       // Blocks the stream's misses evicted
+    uint64_t crossEvictions = 0;  // Of those, blocks another stream had brought in
+    uint64_t evictedByOthers = 0; // Blocks the stream brought in that another stream's misses evicted
+};
+
+/**
+ * Struct representing one trace input, its reader thread and the ring of
+ * batches the thread fills. head and tail count batches; the reader owns the
+ * slots from tail up to head + STREAM_QUEUE_BATCHES, the simulation the rest.
+ */
+struct Stream
+{
+    std::string path;
+    TraceReader reader;
+    std::vector<TraceBatch> slots; // The ring of STREAM_QUEUE_BATCHES batches
+    std::thread thread;
+    alignas(64) std::atomic<size_t> head{0}; // Next batch the simulation takes (written by the simulation)
+    alignas(64) std::atomic<size_t> tail{0}; // Next batch the reader fills (written by the reader)
+    std::atomic<bool> done{false};           // The reader has published its last batch
+
+    // SIMULATION POSITION
+    size_t position = 0; // Next access within the batch at head
+    bool finished = false;
+    StreamStats stats;
+};
+
+/**
+ * Struct representing a replay of several streams over one shared cache.
+ */
+struct StreamReplay
+{
+    Cache cache;
+    std::vector<std::unique_ptr<Stream>> streams; // Streams hold threads and atomics, so they do not move
+    std::vector<uint8_t> owner; // Per slot: the stream whose miss brought the block in
+    InterleavePolicy policy = InterleavePolicy::RoundRobin;
+    std::vector<int> weights; // Weighted: per stream, the turns of quantum accesses it runs in a row
+    uint64_t quantum = 1;     // Accesses a stream runs per turn
+    WayPartition partition;   // Way masks of the streams, one class each, once attached to the cache
+};
+
+/**
+ * Parses an interleaving "round-robin", "time" or "weighted:w1,w2,...", with
+ * one positive weight per stream.
+ *
+ * @param spec The interleaving.
+ * @param numStreams The number of streams replayed.
+ * @param replay Reference to the StreamReplay to configure.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int parseInterleave(const std::string &spec, int numStreams, StreamReplay &replay);
+
+/**
+ * Opens every trace and starts its reader thread. The cache must be set up first.
+ *
+ * @param replay Reference to the StreamReplay.
+ * @param paths The traces to replay, "-" for standard input.
+ *
+ * @return int 0 for success, 1 if a trace could not be opened.
+ */
+int streamsStart(StreamReplay &replay, const std::vector<std::string> &paths);
+
+/**
+ * Interleaves every stream into the shared cache until all have ended, then
+ * joins the reader threads and closes the traces.
+ *
+ * @param replay Reference to the started StreamReplay.
+ */
+void runStreams(StreamReplay &replay);
+
+/**
+ * Prints the counters of every stream, then those of the shared cache.
+ *
+ * @param replay Reference to the StreamReplay.
+ */
+void displayStreams(StreamReplay &replay);
+
+#endif // STREAMS_H
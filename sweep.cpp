@@ -0,0 +1,334 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "sweep.h"
+
+// splits a comma-separated field into its values
+static std::vector<std::string> splitList(const std::string &field)
+{
+    std::vector<std::string> values;
+    std::stringstream stream(field);
+    std::string value;
+    while (std::getline(stream, value, ','))
+    {
+        if (!value.empty())
+        {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+int expandSweepGrid(const std::vector<std::string> &fields, std::vector<SweepConfig> &configs)
+{
+    if (fields.size() != 6)
+    {
+        std::cerr << "Invalid sweep configuration, expected 6 fields. Exiting.\n";
+        return 1;
+    }
+
+    std::vector<std::vector<std::string>> lists;
+    for (const std::string &field : fields)
+    {
+        lists.push_back(splitList(field));
+        if (lists.back().empty())
+        {
+            std::cerr << "Invalid sweep configuration, empty field. Exiting.\n";
+            return 1;
+        }
+    }
+    bool policyGrid = lists[3].size() > 1 || lists[4].size() > 1;
+
+    for (const std::string &sets : lists[0])
+    {
+        for (const std::string &blocks : lists[1])
+        {
+            for (const std::string &bytes : lists[2])
+            {
+                for (const std::string &miss : lists[3])
+                {
+                    for (const std::string &write : lists[4])
+                    {
+                        for (const std::string &eviction : lists[5])
+                        {
+                            // not a real configuration, only an artifact of the grid
+                            if (policyGrid && miss == "no-write-allocate" && write == "write-back")
+                            {
+                                continue;
+                            }
+
+                            SweepConfig config;
+                            config.numSets = std::atoi(sets.c_str());
+                            config.numBlocks = std::atoi(blocks.c_str());
+                            config.numBytes = std::atoi(bytes.c_str());
+                            config.handleMiss = miss;
+                            config.handleWrite = write;
+                            config.handleEviction = eviction;
+                            if (validateArguments(config.numSets, config.numBlocks, config.numBytes, config.handleMiss, config.handleWrite, config.handleEviction) == 1)
+                            {
+                                return 1;
+                            }
+                            configs.push_back(config);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int readSweepFile(const char *path, std::vector<SweepConfig> &configs)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Could not open sweep file " << path << ". Exiting.\n";
+        return 1;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::stringstream stream(line);
+        std::vector<std::string> fields;
+        std::string field;
+        while (stream >> field)
+        {
+            fields.push_back(field);
+        }
+        if (fields.empty() || fields[0][0] == '#')
+        {
+            continue;
+        }
+        if (expandSweepGrid(fields, configs) == 1)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void sweepSetUp(const std::vector<SweepConfig> &configs, std::vector<Cache> &caches)
+{
+    // caches left from an earlier sweep are set up again in place, reusing their allocations
+    caches.resize(configs.size());
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        const SweepConfig &config = configs[i];
+        cacheSetUp(caches[i], config.numSets, config.numBlocks, config.numBytes, config.handleMiss, config.handleWrite, config.handleEviction);
+        timingSetUp(caches[i], TimingModel());
+        cacheClearStatistics(caches[i]);
+    }
+}
+
+void runSweep(std::vector<Cache> &caches, TraceReader &reader)
+{
+    TraceBatch batch(SWEEP_BATCH_SIZE);
+    // decode a batch once, then replay it against each cache while that cache's state is hot
+    while (traceNextBatch(reader, batch) > 0)
+    {
+        for (Cache &cache : caches)
+        {
+            cacheSimulateBatch(cache, batch.loadStore.data(), batch.addresses.data(), batch.count);
+        }
+    }
+
+    for (Cache &cache : caches)
+    {
+        timingDrain(cache);
+    }
+}
+
+/**
+ * Struct representing one chunk of the parallel sweep pipeline.
+ */
+struct SweepChunk
+{
+    TraceBatch batch{SWEEP_PARALLEL_BATCH_SIZE}; // Decoded records, read-only once published
+    int pending = 0;                             // Workers that have not finished this chunk yet
+};
+
+/**
+ * Struct representing the state shared by the reader and the workers.
+ */
+struct SweepPipeline
+{
+    std::vector<SweepChunk> ring;       // Chunks reused round-robin
+    std::mutex lock;                    // Guards every field below and the chunk bookkeeping
+    std::condition_variable published;  // Signalled when a new chunk is ready
+    std::condition_variable drained;    // Signalled when every worker has finished a chunk
+    uint64_t publishedCount = 0;        // Number of chunks made available so far
+    bool finished = false;              // Indicates that no more chunks will be published
+};
+
+// assigns caches to workers, most expensive first onto the least loaded worker
+static std::vector<std::vector<size_t>> shardCaches(const std::vector<Cache> &caches, int numThreads)
+{
+    std::vector<size_t> order(caches.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    // per-access cost grows with the number of slots scanned in a set
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                     { return caches[a].numBlocks > caches[b].numBlocks; });
+
+    std::vector<std::vector<size_t>> shards(numThreads);
+    std::vector<long> load(numThreads, 0);
+    for (size_t i : order)
+    {
+        int least = std::min_element(load.begin(), load.end()) - load.begin();
+        shards[least].push_back(i);
+        load[least] += caches[i].numBlocks + 1;
+    }
+    return shards;
+}
+
+// simulates every published chunk against one shard of the caches
+static void sweepWorker(SweepPipeline &pipeline, std::vector<Cache> &caches, const std::vector<size_t> &shard)
+{
+    // work on private copies so counters of caches owned by different
+    // workers never share a host cache line
+    std::vector<Cache> local;
+    for (size_t i : shard)
+    {
+        local.push_back(std::move(caches[i]));
+    }
+
+    for (uint64_t next = 0;; next++)
+    {
+        SweepChunk *chunk;
+        {
+            std::unique_lock<std::mutex> guard(pipeline.lock);
+            pipeline.published.wait(guard, [&]()
+                                    { return pipeline.publishedCount > next || pipeline.finished; });
+            if (pipeline.publishedCount <= next)
+            {
+                break;
+            }
+            chunk = &pipeline.ring[next % pipeline.ring.size()];
+        }
+
+        for (Cache &cache : local)
+        {
+            cacheSimulateBatch(cache, chunk->batch.loadStore.data(), chunk->batch.addresses.data(), chunk->batch.count);
+        }
+
+        std::lock_guard<std::mutex> guard(pipeline.lock);
+        if (--chunk->pending == 0)
+        {
+            pipeline.drained.notify_one();
+        }
+    }
+
+    for (size_t i = 0; i < shard.size(); i++)
+    {
+        caches[shard[i]] = std::move(local[i]);
+    }
+}
+
+void runSweepParallel(std::vector<Cache> &caches, TraceReader &reader, int numThreads)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min<size_t>(numThreads, caches.size());
+    if (numThreads <= 1)
+    {
+        runSweep(caches, reader);
+        return;
+    }
+
+    std::vector<std::vector<size_t>> shards = shardCaches(caches, numThreads);
+    SweepPipeline pipeline;
+    pipeline.ring.resize(SWEEP_PIPELINE_DEPTH);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++)
+    {
+        workers.emplace_back(sweepWorker, std::ref(pipeline), std::ref(caches), std::cref(shards[t]));
+    }
+
+    // decode chunk k+1 while the workers simulate chunk k
+    for (uint64_t k = 0;; k++)
+    {
+        SweepChunk &chunk = pipeline.ring[k % pipeline.ring.size()];
+        {
+            std::unique_lock<std::mutex> guard(pipeline.lock);
+            pipeline.drained.wait(guard, [&]()
+                                  { return chunk.pending == 0; });
+        }
+
+        size_t count = traceNextBatch(reader, chunk.batch);
+        if (count == 0)
+        {
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(pipeline.lock);
+            chunk.pending = numThreads;
+            pipeline.publishedCount = k + 1;
+        }
+        pipeline.published.notify_all();
+
+        if (count < SWEEP_PARALLEL_BATCH_SIZE)
+        {
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(pipeline.lock);
+        pipeline.finished = true;
+    }
+    pipeline.published.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    for (Cache &cache : caches)
+    {
+        timingDrain(cache);
+    }
+}
+
+void displaySweep(const std::vector<SweepConfig> &configs, std::vector<Cache> &caches, bool table)
+{
+    if (table)
+    {
+        std::cout << "sets blocks bytes miss write eviction loads stores load_hits load_misses store_hits store_misses cycles" << std::endl;
+    }
+
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        const SweepConfig &config = configs[i];
+        Cache &cache = caches[i];
+        if (table)
+        {
+            std::cout << config.numSets << ' ' << config.numBlocks << ' ' << config.numBytes << ' '
+                      << config.handleMiss << ' ' << config.handleWrite << ' ' << config.handleEviction << ' '
+                      << cache.loadCount << ' ' << cache.storeCount << ' '
+                      << cache.loadHits << ' ' << cache.loadMisses << ' '
+                      << cache.storeHits << ' ' << cache.storeMisses << ' '
+                      << cache.totalCycles << std::endl;
+        }
+        else
+        {
+            if (i > 0)
+            {
+                std::cout << std::endl;
+            }
+            std::cout << "Configuration: " << config.numSets << ' ' << config.numBlocks << ' ' << config.numBytes << ' '
+                      << config.handleMiss << ' ' << config.handleWrite << ' ' << config.handleEviction << std::endl;
+            displayStatistics(cache);
+        }
+    }
+}
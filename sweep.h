@@ -0,0 +1,94 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+#include "trace_reader.h"
+
+// number of trace records decoded at a time and replayed against every cache
+static const size_t SWEEP_BATCH_SIZE = 4096;
+// larger chunks for the parallel engine, so synchronization is amortized over more work
+static const size_t SWEEP_PARALLEL_BATCH_SIZE = 1 << 16;
+// number of chunks in flight: one being decoded while the others are simulated
+static const int SWEEP_PIPELINE_DEPTH = 3;
+
+/**
+ * Struct representing one cache configuration of a sweep.
+ * Holds the same six parameters as a single csim run.
+ */
+struct SweepConfig
+{
+    int numSets;
+    int numBlocks;
+    int numBytes; // block size
+    std::string handleMiss;
+    std::string handleWrite;
+    std::string handleEviction;
+};
+
+/**
+ * Expands a grid of configuration fields into individual configurations.
+ * Each field may be a single value or a comma-separated list, and every
+ * combination is produced. Combinations of no-write-allocate with write-back
+ * are skipped when either field is a list; all others are validated.
+ *
+ * @param fields The six configuration fields, in command-line order.
+ * @param configs Reference to the vector the expanded configurations are appended to.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int expandSweepGrid(const std::vector<std::string> &fields, std::vector<SweepConfig> &configs);
+
+/**
+ * Reads sweep configurations from a file, one grid per line.
+ * Blank lines and lines starting with '#' are ignored.
+ *
+ * @param path Path of the configuration file.
+ * @param configs Reference to the vector the configurations are appended to.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int readSweepFile(const char *path, std::vector<SweepConfig> &configs);
+
+/**
+ * Builds one cache per configuration with cacheSetUp. Caches already in the
+ * vector, from an earlier sweep, are recycled: their allocations are reused
+ * when large enough, and their contents, statistics and timing are reset.
+ *
+ * @param configs The configurations to build.
+ * @param caches Reference to the vector of caches to fill (resized to match).
+ */
+void sweepSetUp(const std::vector<SweepConfig> &configs, std::vector<Cache> &caches);
+
+/**
+ * Simulates every cache over a trace, decoding each record only once.
+ *
+ * @param caches Reference to the caches being simulated.
+ * @param reader Reference to an open TraceReader.
+ */
+void runSweep(std::vector<Cache> &caches, TraceReader &reader);
+
+/**
+ * Simulates every cache over a trace on a pool of worker threads.
+ * The calling thread decodes the trace into a ring of shared read-only chunks
+ * while the workers simulate earlier chunks; each worker owns a fixed shard of
+ * the caches, so the results are identical to runSweep.
+ *
+ * @param caches Reference to the caches being simulated.
+ * @param reader Reference to an open TraceReader.
+ * @param numThreads Number of worker threads (0 for one per hardware thread).
+ */
+void runSweepParallel(std::vector<Cache> &caches, TraceReader &reader, int numThreads);
+
+/**
+ * Displays the statistics of every sweep configuration.
+ *
+ * @param configs The simulated configurations.
+ * @param caches The caches holding the statistics, in the same order.
+ * @param table true for one row per configuration, false for one displayStatistics block each.
+ */
+void displaySweep(const std::vector<SweepConfig> &configs, std::vector<Cache> &caches, bool table);
+
+#endif // SWEEP_H
@@ -0,0 +1,313 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+#include "synthetic.h"
+
+// bytes of a zipfian or pointer-chase block, and of a word
+static const uint64_t SYNTHETIC_BLOCK_BYTES = 64;
+static const uint64_t SYNTHETIC_WORD_BYTES = 8;
+// smallest and largest footprint accepted
+static const uint64_t SYNTHETIC_MIN_FOOTPRINT = 4096;
+static const uint64_t SYNTHETIC_MAX_FOOTPRINT = uint64_t(1) << 40;
+// zipfian ranks summed term by term; the tail of a larger footprint is approximated
+static const uint64_t SYNTHETIC_ZETA_EXACT_RANKS = uint64_t(1) << 20;
+
+// an integer with an optional K, M or G suffix
+static bool parseCount(const std::string &text, uint64_t &value)
+{
+    char *end;
+    long long number = std::strtoll(text.c_str(), &end, 10);
+    int shift = 0;
+    if (*end == 'K' || *end == 'M' || *end == 'G')
+    {
+        shift = *end == 'K' ? 10 : *end == 'M' ? 20 : 30;
+        end++;
+    }
+    if (text.empty() || *end != '\0' || number < 0 || static_cast<uint64_t>(number) > (UINT64_MAX >> shift))
+    {
+        return false;
+    }
+    value = static_cast<uint64_t>(number) << shift;
+    return true;
+}
+
+static uint64_t nextRandom(SyntheticGenerator &generator)
+{
+    uint64_t z = (generator.random += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// uniform in [0, 1)
+static double nextUniform(SyntheticGenerator &generator)
+{
+    return (nextRandom(generator) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// a bijection of the blocks of the footprint onto themselves, which scatters neighbouring numbers
+static uint64_t scatterBlock(const SyntheticGenerator &generator, uint64_t block)
+{
+    uint64_t mask = generator.blocks - 1;
+    int shift = (generator.blockBits + 1) / 2;
+    block = (block * 0x9e3779b97f4a7c15ULL) & mask;
+    block ^= block >> shift;
+    block = (block * 0xc4ceb9fe1a85ec53ULL) & mask;
+    block ^= block >> shift;
+    return block;
+}
+
+// zeta(n) = sum of 1 / rank^theta over ranks 1 to n. Past SYNTHETIC_ZETA_EXACT_RANKS the rest of
+// the sum is its Euler-Maclaurin expansion, whose error there is far below a double's precision,
+// so setup stays constant-time up to the largest footprint
+static double zeta(uint64_t n, double theta)
+{
+    uint64_t exact = std::min(n, SYNTHETIC_ZETA_EXACT_RANKS);
+    double sum = 0;
+    for (uint64_t rank = 1; rank <= exact; rank++)
+    {
+        sum += 1.0 / std::pow(static_cast<double>(rank), theta);
+    }
+    if (n == exact)
+    {
+        return sum;
+    }
+    // ranks exact + 1 to n: the integral of x^-theta over [m, N], half of each end term and the
+    // first two derivative corrections, with m = exact + 1 and N = n
+    double m = static_cast<double>(exact + 1);
+    double top = static_cast<double>(n);
+    auto f = [theta](double x)
+    { return std::pow(x, -theta); };
+    auto f1 = [theta](double x)
+    { return -theta * std::pow(x, -theta - 1); };
+    auto f3 = [theta](double x)
+    { return -theta * (theta + 1) * (theta + 2) * std::pow(x, -theta - 3); };
+    sum += (std::pow(top, 1 - theta) - std::pow(m, 1 - theta)) / (1 - theta);
+    sum += (f(m) + f(top)) / 2;
+    sum += (f1(top) - f1(m)) / 12;
+    sum -= (f3(top) - f3(m)) / 720;
+    return sum;
+}
+
+static int configure(const std::string &spec, SyntheticGenerator &generator)
+{
+    if (generator.footprint < SYNTHETIC_MIN_FOOTPRINT || generator.footprint > SYNTHETIC_MAX_FOOTPRINT ||
+        (generator.footprint & (generator.footprint - 1)) != 0)
+    {
+        std::cerr << "Invalid generator " << spec << ", the footprint must be a power of two from 4K to 1024G. Exiting.\n";
+        return 1;
+    }
+    if (generator.stride == 0 || !(generator.theta > 0 && generator.theta < 1) || generator.storePercent > 100 ||
+        generator.matrixSize == 0 || generator.matrixSize > (1 << 16) || generator.tile == 0 || generator.tile > generator.matrixSize)
+    {
+        std::cerr << "Invalid generator " << spec << ", expected a positive stride, 0 < theta < 1, at most 100% stores,"
+                  << " 1 <= n <= 65536 and 1 <= tile <= n. Exiting.\n";
+        return 1;
+    }
+
+    generator.generated = 0;
+    generator.random = generator.seed;
+    generator.position = 0;
+    generator.blocks = generator.footprint / SYNTHETIC_BLOCK_BYTES;
+    generator.blockBits = 0;
+    while ((uint64_t(1) << generator.blockBits) < generator.blocks)
+    {
+        generator.blockBits++;
+    }
+    if (generator.pattern == SyntheticPattern::Zipfian)
+    {
+        generator.zetaN = zeta(generator.blocks, generator.theta);
+        double zeta2 = 1.0 + 1.0 / std::pow(2.0, generator.theta);
+        generator.alpha = 1.0 / (1.0 - generator.theta);
+        generator.eta = (1.0 - std::pow(2.0 / generator.blocks, 1.0 - generator.theta)) / (1.0 - zeta2 / generator.zetaN);
+    }
+    generator.ii = generator.jj = generator.kk = 0;
+    generator.i = generator.j = generator.k = 0;
+    generator.second = false;
+    return 0;
+}
+
+int parseGenerator(const std::string &spec, SyntheticGenerator &generator)
+{
+    std::stringstream stream(spec);
+    std::string pattern;
+    std::getline(stream, pattern, ':');
+    static const char *names[] = {"sequential", "strided", "random", "zipfian", "pointer-chase", "matrix"};
+    const char **name = std::find(std::begin(names), std::end(names), pattern);
+    if (name == std::end(names))
+    {
+        std::cerr << "Invalid generator " << spec << ", expected sequential, strided, random, zipfian, pointer-chase"
+                  << " or matrix followed by :key=value options. Exiting.\n";
+        return 1;
+    }
+    generator.pattern = static_cast<SyntheticPattern>(name - std::begin(names));
+    generator.stride = generator.pattern == SyntheticPattern::Strided ? 256 : SYNTHETIC_WORD_BYTES;
+
+    std::string field;
+    while (std::getline(stream, field, ':'))
+    {
+        size_t equals = field.find('=');
+        std::string key = field.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : field.substr(equals + 1);
+        uint64_t number = 0;
+        bool valid = key == "theta" || parseCount(value, number);
+        if (key == "accesses")
+        {
+            generator.accesses = number;
+        }
+        else if (key == "footprint")
+        {
+            generator.footprint = number;
+        }
+        else if (key == "stride")
+        {
+            generator.stride = number;
+        }
+        else if (key == "theta")
+        {
+            char *end;
+            generator.theta = std::strtod(value.c_str(), &end);
+            valid = !value.empty() && *end == '\0';
+        }
+        else if (key == "stores")
+        {
+            generator.storePercent = static_cast<int>(std::min<uint64_t>(number, 101));
+        }
+        else if (key == "seed")
+        {
+            generator.seed = number;
+        }
+        else if (key == "n")
+        {
+            generator.matrixSize = number;
+        }
+        else if (key == "tile")
+        {
+            generator.tile = number;
+        }
+        else
+        {
+            valid = false;
+        }
+        if (!valid)
+        {
+            std::cerr << "Invalid generator option " << field << " in " << spec << ". Exiting.\n";
+            return 1;
+        }
+    }
+    return configure(spec, generator);
+}
+
+// the next access of the tiled matrix multiplication: for each tile (ii, jj, kk) and each (i, j)
+// in it, a load of A[i][k] and B[k][j] for every k of the tile, then a store of C[i][j]
+static void nextMatrixAccess(SyntheticGenerator &generator, char &loadStore, uint64_t &address)
+{
+    uint64_t n = generator.matrixSize;
+    uint64_t tile = generator.tile;
+    uint64_t matrixBytes = n * n * SYNTHETIC_WORD_BYTES;
+    if (generator.k < std::min(generator.kk + tile, n))
+    {
+        loadStore = 'l';
+        if (!generator.second)
+        {
+            address = SYNTHETIC_BASE + (generator.i * n + generator.k) * SYNTHETIC_WORD_BYTES;
+        }
+        else
+        {
+            address = SYNTHETIC_BASE + matrixBytes + (generator.k * n + generator.j) * SYNTHETIC_WORD_BYTES;
+            generator.k++;
+        }
+        generator.second = !generator.second;
+        return;
+    }
+    loadStore = 's';
+    address = SYNTHETIC_BASE + 2 * matrixBytes + (generator.i * n + generator.j) * SYNTHETIC_WORD_BYTES;
+
+    // the next (i, j) of the tile, or the next tile, or the first one again
+    generator.k = generator.kk;
+    if (++generator.j < std::min(generator.jj + tile, n))
+    {
+        return;
+    }
+    generator.j = generator.jj;
+    if (++generator.i < std::min(generator.ii + tile, n))
+    {
+        return;
+    }
+    generator.i = generator.ii;
+    generator.kk += tile;
+    if (generator.kk < n)
+    {
+        generator.k = generator.kk;
+        return;
+    }
+    generator.kk = generator.k = 0;
+    generator.jj += tile;
+    if (generator.jj < n)
+    {
+        generator.j = generator.jj;
+        return;
+    }
+    generator.jj = generator.j = 0;
+    generator.ii = generator.ii + tile < n ? generator.ii + tile : 0;
+    generator.i = generator.ii;
+}
+
+// a zipfian rank, 0 the most frequent
+static uint64_t nextZipfianRank(SyntheticGenerator &generator)
+{
+    double u = nextUniform(generator);
+    double uz = u * generator.zetaN;
+    if (uz < 1.0)
+    {
+        return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, generator.theta))
+    {
+        return 1;
+    }
+    uint64_t rank = static_cast<uint64_t>(generator.blocks * std::pow(generator.eta * u - generator.eta + 1.0, generator.alpha));
+    return std::min(rank, generator.blocks - 1);
+}
+
+size_t generatorNextBatch(SyntheticGenerator &generator, TraceBatch &batch)
+{
+    size_t count = static_cast<size_t>(std::min<uint64_t>(batch.addresses.size(), generator.accesses - generator.generated));
+    char *loadStore = batch.loadStore.data();
+    uint64_t *addresses = batch.addresses.data();
+    uint64_t footprintMask = generator.footprint - 1;
+    for (size_t n = 0; n < count; n++)
+    {
+        uint64_t offset;
+        switch (generator.pattern)
+        {
+        case SyntheticPattern::Sequential:
+        case SyntheticPattern::Strided:
+            offset = generator.position;
+            generator.position = (generator.position + generator.stride) & footprintMask;
+            break;
+        case SyntheticPattern::Random:
+            offset = nextRandom(generator) & footprintMask & ~(SYNTHETIC_WORD_BYTES - 1);
+            break;
+        case SyntheticPattern::Zipfian:
+            offset = scatterBlock(generator, nextZipfianRank(generator)) * SYNTHETIC_BLOCK_BYTES;
+            break;
+        case SyntheticPattern::PointerChase:
+            loadStore[n] = 'l';
+            addresses[n] = SYNTHETIC_BASE + scatterBlock(generator, generator.position) * SYNTHETIC_BLOCK_BYTES;
+            generator.position = (generator.position + 1) & (generator.blocks - 1);
+            continue;
+        default:
+            nextMatrixAccess(generator, loadStore[n], addresses[n]);
+            continue;
+        }
+        loadStore[n] = nextRandom(generator) % 100 < static_cast<uint64_t>(generator.storePercent) ? 's' : 'l';
+        addresses[n] = SYNTHETIC_BASE + offset;
+    }
+    generator.generated += count;
+    batch.count = count;
+    return count;
+}
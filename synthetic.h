@@ -0,0 +1,95 @@
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <cstdint>
+#include <string>
+
+#include "trace_reader.h"
+
+// SYNTHETIC TRACES
+//
+// A generator produces the accesses of a reproducible workload straight into
+// TraceBatch arrays, the same way traceNextBatch does for a trace file, so no
+// trace is stored or formatted as text and no memory is allocated per batch.
+// Patterns, over a footprint starting at SYNTHETIC_BASE:
+// - sequential: 8-byte words one after the other (a stride of 8);
+// - strided: every stride bytes;
+// - random: uniformly random 8-byte words;
+// - zipfian: 64-byte blocks drawn with probability proportional to
+//   1 / rank^theta, the ranks scattered over the footprint (the method of Gray
+//   et al., "Quickly generating billion-record synthetic databases", which
+//   needs no table);
+// - pointer-chase: loads that visit every 64-byte block once per lap in a
+//   random cyclic order, as following a shuffled linked list does;
+// - matrix: a tiled n x n matrix multiplication of doubles, C += A * B, with
+//   tile x tile blocks: loads of A and B, a store of C per inner loop.
+// The first four wrap around the footprint; pointer-chase and matrix start
+// over when they are done. Every pattern stops after `accesses` accesses.
+
+// first address of every synthetic footprint
+static const uint64_t SYNTHETIC_BASE = 0x10000000;
+
+enum class SyntheticPattern
+{
+    Sequential,
+    Strided,
+    Random,
+    Zipfian,
+    PointerChase,
+    Matrix
+};
+
+/**
+ * Struct representing a synthetic trace generator.
+ */
+struct SyntheticGenerator
+{
+    // CONFIGURATION
+    SyntheticPattern pattern = SyntheticPattern::Sequential;
+    uint64_t accesses = 10000000;   // Accesses generated in all
+    uint64_t footprint = 64 << 20;  // Bytes covered, a power of two (not used by matrix)
+    uint64_t stride = 8;            // Bytes between strided accesses (sequential: 8)
+    double theta = 0.99;            // Zipfian skew, between 0 and 1
+    int storePercent = 25;          // Stores among the accesses of the first four patterns
+    uint64_t seed = 1;              // Seed of every random choice
+    uint64_t matrixSize = 512;      // Matrix: rows and columns
+    uint64_t tile = 32;             // Matrix: rows and columns of a tile
+
+    // STATE
+    uint64_t generated = 0; // Accesses produced so far
+    uint64_t random = 0;    // splitmix64 state
+    uint64_t position = 0;  // Sequential and strided: offset in the footprint; pointer-chase: lap position
+    uint64_t blocks = 0;    // 64-byte blocks in the footprint
+    int blockBits = 0;      // log2(blocks)
+    double zetaN = 0;       // Zipfian: sum of 1 / i^theta over every rank
+    double alpha = 0;       // Zipfian: 1 / (1 - theta)
+    double eta = 0;         // Zipfian: Gray et al.'s eta
+    uint64_t ii = 0, jj = 0, kk = 0, i = 0, j = 0, k = 0; // Matrix: tile origin and position within it
+    bool second = false;    // Matrix: the load of B for the current k is next
+};
+
+/**
+ * Parses a generator specification "pattern[:key=value...]", the pattern one
+ * of sequential, strided, random, zipfian, pointer-chase or matrix, and the
+ * keys accesses, footprint, stride, theta, stores (percent), seed, n and tile.
+ * Integers take a K, M or G suffix (1024, 1024^2, 1024^3). The generator is
+ * then ready to produce its first batch.
+ *
+ * @param spec The specification.
+ * @param generator Reference to the SyntheticGenerator to configure.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int parseGenerator(const std::string &spec, SyntheticGenerator &generator);
+
+/**
+ * Produces the next run of accesses into a batch, up to its capacity.
+ *
+ * @param generator Reference to the configured SyntheticGenerator.
+ * @param batch Reference to the TraceBatch receiving the accesses.
+ *
+ * @return size_t The number of accesses produced, 0 once all have been.
+ */
+size_t generatorNextBatch(SyntheticGenerator &generator, TraceBatch &batch);
+
+#endif // SYNTHETIC_H
@@ -0,0 +1,247 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSIM_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CSIM_NEON 1
+#endif
+
+#include "tag_match.h"
+
+// below this associativity a short scalar loop beats setting up a vector compare
+static const int TAG_MATCH_MIN_VECTOR_WAYS = 8;
+
+// valid bits of the ways starting at way (way is a multiple of the vector width)
+static inline uint64_t validBits(const uint64_t *valid, int way)
+{
+    return valid[way >> 6] >> (way & 63);
+}
+
+#ifdef CSIM_X86
+__attribute__((target("avx2"))) static int tagMatchAVX2(const uint32_t *tags, const uint64_t *valid, int numBlocks, uint32_t tag)
+{
+    const __m256i needle = _mm256_set1_epi32(static_cast<int>(tag));
+    for (int way = 0; way < numBlocks; way += 8)
+    {
+        __m256i chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(tags + way));
+        uint32_t equal = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(chunk, needle)));
+        uint32_t hits = equal & static_cast<uint32_t>(validBits(valid, way) & 0xff);
+        if (hits != 0)
+        {
+            return way + __builtin_ctz(hits);
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("avx512f"))) static int tagMatchAVX512(const uint32_t *tags, const uint64_t *valid, int numBlocks, uint32_t tag)
+{
+    const __m512i needle = _mm512_set1_epi32(static_cast<int>(tag));
+    for (int way = 0; way < numBlocks; way += 16)
+    {
+        __m512i chunk = _mm512_load_si512(reinterpret_cast<const void *>(tags + way));
+        uint32_t hits = _mm512_mask_cmpeq_epi32_mask(static_cast<__mmask16>(validBits(valid, way) & 0xffff), chunk, needle);
+        if (hits != 0)
+        {
+            return way + __builtin_ctz(hits);
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("avx2"))) static int wideTagMatchAVX2(const uint64_t *tags, const uint64_t *valid, int numBlocks, uint64_t tag)
+{
+    const __m256i needle = _mm256_set1_epi64x(static_cast<long long>(tag));
+    for (int way = 0; way < numBlocks; way += 4)
+    {
+        __m256i chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(tags + way));
+        uint32_t equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(chunk, needle)));
+        uint32_t hits = equal & static_cast<uint32_t>(validBits(valid, way) & 0xf);
+        if (hits != 0)
+        {
+            return way + __builtin_ctz(hits);
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("avx512f"))) static int wideTagMatchAVX512(const uint64_t *tags, const uint64_t *valid, int numBlocks, uint64_t tag)
+{
+    const __m512i needle = _mm512_set1_epi64(static_cast<long long>(tag));
+    for (int way = 0; way < numBlocks; way += 8)
+    {
+        __m512i chunk = _mm512_load_si512(reinterpret_cast<const void *>(tags + way));
+        uint32_t hits = _mm512_mask_cmpeq_epi64_mask(static_cast<__mmask8>(validBits(valid, way) & 0xff), chunk, needle);
+        if (hits != 0)
+        {
+            return way + __builtin_ctz(hits);
+        }
+    }
+    return -1;
+}
+#endif
+
+#ifdef CSIM_NEON
+static int tagMatchNEON(const uint32_t *tags, const uint64_t *valid, int numBlocks, uint32_t tag)
+{
+    static const uint32_t weights[4] = {1, 2, 4, 8};
+    const uint32x4_t needle = vdupq_n_u32(tag);
+    const uint32x4_t lanes = vld1q_u32(weights);
+    for (int way = 0; way < numBlocks; way += 4)
+    {
+        uint32x4_t equal = vceqq_u32(vld1q_u32(tags + way), needle);
+        uint32_t hits = vaddvq_u32(vandq_u32(equal, lanes)) & static_cast<uint32_t>(validBits(valid, way) & 0xf);
+        if (hits != 0)
+        {
+            return way + __builtin_ctz(hits);
+        }
+    }
+    return -1;
+}
+
+static int wideTagMatchNEON(const uint64_t *tags, const uint64_t *valid, int numBlocks, uint64_t tag)
+{
+    const uint64x2_t needle = vdupq_n_u64(tag);
+    for (int way = 0; way < numBlocks; way += 2)
+    {
+        uint64x2_t equal = vceqq_u64(vld1q_u64(tags + way), needle);
+        uint32_t hits = static_cast<uint32_t>((vgetq_lane_u64(equal, 0) & 1) | (vgetq_lane_u64(equal, 1) & 2)) & static_cast<uint32_t>(validBits(valid, way) & 0x3);
+        if (hits != 0)
+        {
+            return way + __builtin_ctz(hits);
+        }
+    }
+    return -1;
+}
+#endif
+
+// the vector kernels being cross-checked in "check" mode
+static TagMatchFunction checkedKernel = tagMatchScalar<uint32_t>;
+static WideTagMatchFunction checkedWideKernel = tagMatchScalar<uint64_t>;
+
+template <typename Tag>
+static void checkMatch(int expected, int actual, int numBlocks, Tag tag)
+{
+    if (expected != actual)
+    {
+        std::cerr << "Tag match mismatch: " << tagMatchName() << " found way " << actual
+                  << ", scalar found way " << expected << " (tag " << tag << ", " << numBlocks << " ways).\n";
+        std::abort();
+    }
+}
+
+static int tagMatchCheck(const uint32_t *tags, const uint64_t *valid, int numBlocks, uint32_t tag)
+{
+    int actual = checkedKernel(tags, valid, numBlocks, tag);
+    checkMatch(tagMatchScalar(tags, valid, numBlocks, tag), actual, numBlocks, tag);
+    return actual;
+}
+
+static int wideTagMatchCheck(const uint64_t *tags, const uint64_t *valid, int numBlocks, uint64_t tag)
+{
+    int actual = checkedWideKernel(tags, valid, numBlocks, tag);
+    checkMatch(tagMatchScalar(tags, valid, numBlocks, tag), actual, numBlocks, tag);
+    return actual;
+}
+
+/**
+ * Struct representing the kernel choice made once per process.
+ */
+struct TagMatchChoice
+{
+    TagMatchFunction kernel;         // Kernel for sets of at least TAG_MATCH_MIN_VECTOR_WAYS ways
+    WideTagMatchFunction wideKernel; // The same kernel for 64-bit tags
+    const char *name;                // Name reported by tagMatchName
+};
+
+static TagMatchChoice bestKernel()
+{
+#ifdef CSIM_X86
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return {tagMatchAVX512, wideTagMatchAVX512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {tagMatchAVX2, wideTagMatchAVX2, "avx2"};
+    }
+#endif
+#ifdef CSIM_NEON
+    return {tagMatchNEON, wideTagMatchNEON, "neon"};
+#endif
+    return {tagMatchScalar<uint32_t>, tagMatchScalar<uint64_t>, "scalar"};
+}
+
+static TagMatchChoice chooseKernel()
+{
+    TagMatchChoice best = bestKernel();
+    const char *mode = std::getenv("CSIM_TAG_MATCH");
+    if (mode == nullptr || *mode == '\0')
+    {
+        return best;
+    }
+    if (std::strcmp(mode, "scalar") == 0)
+    {
+        return {tagMatchScalar<uint32_t>, tagMatchScalar<uint64_t>, "scalar"};
+    }
+    if (std::strcmp(mode, "check") == 0)
+    {
+        checkedKernel = best.kernel;
+        checkedWideKernel = best.wideKernel;
+        return {tagMatchCheck, wideTagMatchCheck, best.name};
+    }
+#ifdef CSIM_X86
+    if (std::strcmp(mode, "avx2") == 0 && __builtin_cpu_supports("avx2"))
+    {
+        return {tagMatchAVX2, wideTagMatchAVX2, "avx2"};
+    }
+    if (std::strcmp(mode, "avx512") == 0 && __builtin_cpu_supports("avx512f"))
+    {
+        return {tagMatchAVX512, wideTagMatchAVX512, "avx512"};
+    }
+#endif
+#ifdef CSIM_NEON
+    if (std::strcmp(mode, "neon") == 0)
+    {
+        return {tagMatchNEON, wideTagMatchNEON, "neon"};
+    }
+#endif
+    std::cerr << "CSIM_TAG_MATCH=" << mode << " is not supported here, using " << best.name << ".\n";
+    return best;
+}
+
+static const TagMatchChoice &tagMatchChoice()
+{
+    static const TagMatchChoice choice = chooseKernel();
+    return choice;
+}
+
+TagMatchFunction selectTagMatch(int numBlocks)
+{
+    const TagMatchChoice &choice = tagMatchChoice();
+    // check mode covers every associativity so it can be trusted as a test
+    if (numBlocks < TAG_MATCH_MIN_VECTOR_WAYS && choice.kernel != tagMatchCheck)
+    {
+        return tagMatchScalar<uint32_t>;
+    }
+    return choice.kernel;
+}
+
+WideTagMatchFunction selectWideTagMatch(int numBlocks)
+{
+    const TagMatchChoice &choice = tagMatchChoice();
+    if (numBlocks < TAG_MATCH_MIN_VECTOR_WAYS && choice.kernel != tagMatchCheck)
+    {
+        return tagMatchScalar<uint64_t>;
+    }
+    return choice.wideKernel;
+}
+
+const char *tagMatchName()
+{
+    return tagMatchChoice().name;
+}
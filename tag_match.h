@@ -0,0 +1,74 @@
+#ifndef TAGMATCH_H
+#define TAGMATCH_H
+
+#include <cstdint>
+
+// TAG MATCH KERNELS
+//
+// A kernel searches one set for a valid way holding a tag. tags points at the
+// set's tag array, which cacheSetUp pads to whole 64-byte lines and aligns, so
+// vector kernels may read in 8- or 16-tag chunks up to the padded size without
+// a scalar tail; padding ways are never marked valid. Caches keep 32-bit tags
+// while every tag fits and switch to 64-bit tags otherwise, so every kernel
+// comes in both widths.
+
+/**
+ * Searches one set for a tag.
+ *
+ * @param tags The set's tag array (64-byte aligned, padded to a multiple of 16 entries).
+ * @param valid The set's valid bitmask, one bit per way.
+ * @param numBlocks The number of ways in the set.
+ * @param tag The tag to look for.
+ * @return The first valid way holding the tag, or -1 if there is none.
+ */
+typedef int (*TagMatchFunction)(const uint32_t *tags, const uint64_t *valid, int numBlocks, uint32_t tag);
+
+/**
+ * Searches one set of 64-bit tags for a tag; see TagMatchFunction.
+ */
+typedef int (*WideTagMatchFunction)(const uint64_t *tags, const uint64_t *valid, int numBlocks, uint64_t tag);
+
+/**
+ * Portable kernel, used for low associativity and as the reference.
+ * Defined inline so findBlock can call it directly instead of through the pointer.
+ */
+template <typename Tag>
+inline int tagMatchScalar(const Tag *tags, const uint64_t *valid, int numBlocks, Tag tag)
+{
+    for (int way = 0; way < numBlocks; way++)
+    {
+        // check if the slot contains a valid block and if the tag matches
+        if (tags[way] == tag && ((valid[way >> 6] >> (way & 63)) & 1))
+        {
+            return way;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Chooses the kernel for sets of a given associativity.
+ * The fastest kernel the CPU supports is picked at run time (AVX-512, AVX2 or
+ * NEON); the CSIM_TAG_MATCH environment variable can force "scalar", "avx2",
+ * "avx512" or "neon", or select "check", which runs the chosen vector kernel
+ * and the scalar kernel on every lookup and aborts if they ever disagree.
+ *
+ * @param numBlocks The number of ways per set.
+ * @return The kernel to use for that associativity.
+ */
+TagMatchFunction selectTagMatch(int numBlocks);
+
+/**
+ * Chooses the 64-bit tag kernel for sets of a given associativity, the same way as selectTagMatch.
+ *
+ * @param numBlocks The number of ways per set.
+ * @return The kernel to use for that associativity.
+ */
+WideTagMatchFunction selectWideTagMatch(int numBlocks);
+
+/**
+ * Name of the kernel selectTagMatch picks for wide sets, for diagnostics.
+ */
+const char *tagMatchName();
+
+#endif // TAGMATCH_H
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+
+#include "timing.h"
+#include "cache_simulator.h"
+
+// field of a TimingModel named by a timing file key, or nullptr if the key is unknown
+static int *timingField(TimingModel &timing, const std::string &key)
+{
+    if (key == "hit_latency")
+    {
+        return &timing.hitLatency;
+    }
+    if (key == "fill_latency")
+    {
+        return &timing.fillLatency;
+    }
+    if (key == "memory_latency")
+    {
+        return &timing.memoryLatency;
+    }
+    if (key == "memory_cycles_per_byte")
+    {
+        return &timing.memoryCyclesPerByte;
+    }
+    if (key == "write_buffer_depth")
+    {
+        return &timing.writeBufferDepth;
+    }
+    if (key == "write_coalescing")
+    {
+        return &timing.writeCoalescing;
+    }
+    if (key == "mshrs")
+    {
+        return &timing.mshrs;
+    }
+    return nullptr;
+}
+
+int readTimingFile(const char *path, std::vector<TimingModel> &levels)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Could not open timing file " << path << ". Exiting.\n";
+        return 1;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::stringstream stream(line);
+        std::string key;
+        std::string value;
+        if (!(stream >> key) || key[0] == '#')
+        {
+            continue;
+        }
+        std::string extra;
+        if (!(stream >> value) || (stream >> extra))
+        {
+            std::cerr << "Invalid timing line \"" << line << "\", expected a key and a value. Exiting.\n";
+            return 1;
+        }
+        char *end;
+        long number = std::strtol(value.c_str(), &end, 10);
+        if (*end != '\0' || number < 0)
+        {
+            std::cerr << "Invalid timing value " << value << ", expected a non-negative integer. Exiting.\n";
+            return 1;
+        }
+
+        // "L<n>.key" scopes a key to one level; levels deeper than the run has are skipped,
+        // so one file can describe a whole hierarchy
+        size_t first = 0;
+        size_t last = levels.size();
+        size_t dot = key.find('.');
+        if (dot != std::string::npos)
+        {
+            // the level is all digits from just after the L up to the dot: no sign, space or suffix
+            char *levelEnd;
+            size_t level = std::strtoul(key.c_str() + 1, &levelEnd, 10);
+            if (key[0] != 'L' || !std::isdigit(static_cast<unsigned char>(key[1])) || levelEnd != key.c_str() + dot ||
+                level < 1)
+            {
+                std::cerr << "Invalid timing level in " << key << ". Exiting.\n";
+                return 1;
+            }
+            first = std::min(level - 1, levels.size());
+            last = std::min(level, levels.size());
+            key = key.substr(dot + 1);
+        }
+
+        TimingModel probe;
+        if (timingField(probe, key) == nullptr)
+        {
+            std::cerr << "Invalid timing key " << key << ". Exiting.\n";
+            return 1;
+        }
+        for (size_t i = first; i < last; i++)
+        {
+            *timingField(levels[i], key) = static_cast<int>(number);
+        }
+    }
+    return 0;
+}
+
+void timingSetUp(Cache &cache, const TimingModel &timing)
+{
+    cache.timing = timing;
+    cache.mshrDone.assign(timing.mshrs, 0);
+    cache.mshrAddress.assign(timing.mshrs, 0);
+    cache.writeDone.assign(timing.writeBufferDepth, 0);
+    cache.writeAddress.assign(timing.writeBufferDepth, 0);
+    cache.writeNext = 0;
+}
+
+void chargeFill(Cache &cache, uint64_t cycles, uint64_t address)
+{
+    if (cache.timing.mshrs == 0)
+    {
+        cache.totalCycles += cycles;
+        return;
+    }
+    // take the register that frees up first, waiting for it if every miss is still outstanding
+    size_t mshr = 0;
+    for (size_t i = 1; i < cache.mshrDone.size(); i++)
+    {
+        if (cache.mshrDone[i] < cache.mshrDone[mshr])
+        {
+            mshr = i;
+        }
+    }
+    if (cache.mshrDone[mshr] > cache.totalCycles)
+    {
+        cache.totalCycles = cache.mshrDone[mshr];
+    }
+    cache.mshrDone[mshr] = cache.totalCycles + cycles;
+    cache.mshrAddress[mshr] = address;
+}
+
+bool chargePrefetch(Cache &cache, uint64_t cycles, uint64_t address)
+{
+    for (size_t i = 0; i < cache.mshrDone.size(); i++)
+    {
+        if (cache.mshrDone[i] <= cache.totalCycles)
+        {
+            cache.mshrDone[i] = cache.totalCycles + cycles;
+            cache.mshrAddress[i] = address;
+            return true;
+        }
+    }
+    return cache.timing.mshrs == 0;
+}
+
+void waitForFill(Cache &cache, uint64_t address)
+{
+    for (size_t i = 0; i < cache.mshrDone.size(); i++)
+    {
+        if (cache.mshrAddress[i] == address && cache.mshrDone[i] > cache.totalCycles)
+        {
+            cache.totalCycles = cache.mshrDone[i];
+        }
+    }
+}
+
+void chargeWrite(Cache &cache, uint64_t cycles, uint64_t address)
+{
+    int depth = cache.timing.writeBufferDepth;
+    if (depth == 0)
+    {
+        cache.totalCycles += cycles;
+        return;
+    }
+    if (cache.timing.writeCoalescing)
+    {
+        // writes drain in ring order, so a write is still waiting while the one before it is unfinished
+        for (int age = 1; age < depth; age++)
+        {
+            int entry = (cache.writeNext + age) % depth;
+            if (cache.writeAddress[entry] == address && cache.writeDone[(entry + depth - 1) % depth] > cache.totalCycles)
+            {
+                cache.coalescedWrites++;
+                return;
+            }
+        }
+    }
+    // writeDone is a ring of completion times; the next entry is the oldest write
+    uint64_t &oldest = cache.writeDone[cache.writeNext];
+    if (oldest > cache.totalCycles)
+    {
+        cache.writeStalls++;
+        cache.writeStallCycles += oldest - cache.totalCycles;
+        cache.totalCycles = oldest; // buffer full
+    }
+    uint64_t previous = cache.writeDone[(cache.writeNext + depth - 1) % depth];
+    uint64_t start = previous > cache.totalCycles ? previous : cache.totalCycles;
+    oldest = start + cycles;
+    cache.writeAddress[cache.writeNext] = address;
+    cache.bufferedWrites++;
+    cache.writeNext = (cache.writeNext + 1) % depth;
+}
+
+void timingDrain(Cache &cache)
+{
+    for (uint64_t done : cache.mshrDone)
+    {
+        if (done > cache.totalCycles)
+        {
+            cache.totalCycles = done;
+        }
+    }
+    for (uint64_t done : cache.writeDone)
+    {
+        if (done > cache.totalCycles)
+        {
+            cache.totalCycles = done;
+        }
+    }
+}
+
+void displayWriteBufferStatistics(const Cache &cache)
+{
+    std::cout << "Buffered writes: " << cache.bufferedWrites << std::endl;
+    std::cout << "Coalesced writes: " << cache.coalescedWrites << std::endl;
+    std::cout << "Write buffer stalls: " << cache.writeStalls << std::endl;
+    std::cout << "Write buffer stall cycles: " << cache.writeStallCycles << std::endl;
+}
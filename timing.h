@@ -0,0 +1,118 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <cstdint>
+#include <vector>
+
+// TIMING MODEL
+//
+// Cycle costs charged by a cache. The defaults reproduce the original fixed
+// costs: 1 cycle per hit and per fill, 100 cycles per 4-byte word moved to or
+// from memory, and every miss and write stalling for its full cost.
+//
+// With mshrs > 0, misses no longer block: each occupies one of mshrs miss
+// status holding registers until its fill completes, an access waits only for
+// a free register or for the fill of the block it touches, and independent
+// misses overlap. With writeBufferDepth > 0, writes to the next level or memory
+// (write-through stores, stores that do not allocate, write-backs) queue in a
+// buffer that drains one write at a time, and only a full buffer stalls. With
+// writeCoalescing also set, a write to a block that already has a write
+// waiting in the buffer (queued behind another, not yet draining) merges into
+// it and costs nothing.
+
+struct Cache;
+
+/**
+ * Struct representing the latencies and parallelism of one cache level.
+ */
+struct TimingModel
+{
+    int hitLatency = 1;           // Cycles for a hit
+    int fillLatency = 1;          // Cycles for placing a fetched block
+    int memoryLatency = 0;        // Fixed cycles per memory request
+    int memoryCyclesPerByte = 25; // Transfer cycles per byte moved to or from memory
+    int writeBufferDepth = 0;     // Buffered writes in flight (0: writes stall)
+    int writeCoalescing = 0;      // Merge writes to a block already waiting in the buffer (0: off)
+    int mshrs = 0;                // Outstanding misses (0: misses stall)
+};
+
+/**
+ * Cycles for one memory request.
+ * @param timing The timing model of the level making the request
+ * @param bytes The number of bytes moved
+ * @return The request's cost in cycles.
+ */
+inline uint64_t memoryCycles(const TimingModel &timing, int bytes)
+{
+    return timing.memoryLatency + static_cast<uint64_t>(bytes) * timing.memoryCyclesPerByte;
+}
+
+/**
+ * Reads timing models from a file of "key value" lines.
+ * Keys are hit_latency, fill_latency, memory_latency, memory_cycles_per_byte,
+ * write_buffer_depth, write_coalescing and mshrs; a key applies to every level, or only to
+ * level n when prefixed with "L<n>." (L1 is the first level; keys for levels
+ * beyond the end of levels are accepted and ignored).
+ * Blank lines and lines starting with '#' are ignored.
+ *
+ * @param path Path of the timing file.
+ * @param levels Reference to the models to update, first level first.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int readTimingFile(const char *path, std::vector<TimingModel> &levels);
+
+/**
+ * Gives a cache a timing model and clears its outstanding misses and writes.
+ * @param cache The cache, already set up by cacheSetUp
+ * @param timing The timing model to use
+ */
+void timingSetUp(Cache &cache, const TimingModel &timing);
+
+/**
+ * Charges the fetch of a missing block.
+ * @param cache The cache that missed
+ * @param cycles Cycles until the block arrives
+ * @param address Address of the block, so later accesses can wait for its fill
+ */
+void chargeFill(Cache &cache, uint64_t cycles, uint64_t address);
+
+/**
+ * Starts the fetch of a prefetched block. Prefetches never stall: without
+ * MSHRs the fetch is free, and with MSHRs one is taken only if it is free.
+ * @param cache The cache prefetching
+ * @param cycles Cycles until the block arrives
+ * @param address Address of the block, so later accesses can wait for its fill
+ * @return false if every MSHR was busy and the prefetch is dropped.
+ */
+bool chargePrefetch(Cache &cache, uint64_t cycles, uint64_t address);
+
+/**
+ * Stalls an access to a block whose fill is still outstanding.
+ * Only needed when the cache has MSHRs.
+ * @param cache The cache being accessed
+ * @param address Address of the block
+ */
+void waitForFill(Cache &cache, uint64_t address);
+
+/**
+ * Charges a write to the next level or memory.
+ * @param cache The cache writing
+ * @param cycles Cycles the write takes
+ * @param address Address of the block written, which writes coalesce on
+ */
+void chargeWrite(Cache &cache, uint64_t cycles, uint64_t address);
+
+/**
+ * Waits for every outstanding miss and buffered write, so totalCycles covers them.
+ * @param cache The cache to drain
+ */
+void timingDrain(Cache &cache);
+
+/**
+ * Prints the write buffer counters of a cache.
+ * @param cache The cache, which has a write buffer
+ */
+void displayWriteBufferStatistics(const Cache &cache);
+
+#endif // TIMING_H
@@ -0,0 +1,160 @@
+#include <iostream>
+
+#include "trace_binary.h"
+
+static void writeVarint(std::FILE *file, uint64_t value)
+{
+    uint8_t bytes[10];
+    int count = 0;
+    do
+    {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        if (value != 0)
+        {
+            byte |= 0x80;
+        }
+        bytes[count++] = byte;
+    } while (value != 0);
+    std::fwrite(bytes, 1, count, file);
+}
+
+static bool writeHeader(TraceWriter &writer)
+{
+    BinaryTraceHeader header;
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.flags = writer.flags;
+    header.recordCount = writer.recordCount;
+    return std::fwrite(&header, sizeof(header), 1, writer.file) == 1;
+}
+
+int traceWriterOpen(TraceWriter &writer, const char *path, uint32_t flags)
+{
+    writer.file = std::fopen(path, "wb");
+    if (writer.file == nullptr)
+    {
+        std::cerr << "Could not create binary trace " << path << ". Exiting.\n";
+        return 1;
+    }
+    std::setvbuf(writer.file, nullptr, _IOFBF, 1 << 20);
+    writer.flags = flags;
+    writer.recordCount = 0;
+    writer.prevAddress = 0;
+    writer.unencodable = 0;
+
+    // placeholder, rewritten with the real record count on close
+    if (!writeHeader(writer))
+    {
+        std::cerr << "Could not write binary trace header. Exiting.\n";
+        std::fclose(writer.file);
+        writer.file = nullptr;
+        return 1;
+    }
+    return 0;
+}
+
+void traceWrite(TraceWriter &writer, const TraceRecord &record)
+{
+    uint32_t store = (record.loadStore == 's') ? 1 : 0;
+    if (writer.flags & TRACE_FLAG_DELTA)
+    {
+        int64_t delta = static_cast<int64_t>(record.address - writer.prevAddress);
+        uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        if (zigzag >> 63)
+        {
+            writer.unencodable++; // the store bit would push the difference out of 64 bits
+        }
+        writeVarint(writer.file, (zigzag << 1) | store);
+        writeVarint(writer.file, record.size);
+        if (writer.flags & TRACE_FLAG_CORE)
+        {
+            writeVarint(writer.file, record.core);
+        }
+        writer.prevAddress = record.address;
+    }
+    else
+    {
+        if (writer.flags & TRACE_FLAG_WIDE)
+        {
+            std::fwrite(&record.address, sizeof(record.address), 1, writer.file);
+        }
+        else
+        {
+            uint32_t address = static_cast<uint32_t>(record.address);
+            if (address != record.address)
+            {
+                writer.unencodable++;
+            }
+            std::fwrite(&address, sizeof(address), 1, writer.file);
+        }
+        uint32_t field = (record.size << 1) | store;
+        std::fwrite(&field, sizeof(field), 1, writer.file);
+        if (writer.flags & TRACE_FLAG_CORE)
+        {
+            std::fwrite(&record.core, sizeof(record.core), 1, writer.file);
+        }
+    }
+    writer.recordCount++;
+}
+
+int traceWriterClose(TraceWriter &writer)
+{
+    int status = 0;
+    if (writer.unencodable != 0)
+    {
+        if (writer.flags & TRACE_FLAG_DELTA)
+        {
+            std::cerr << writer.unencodable << " addresses are 2^62 or more from the previous one, too far for --delta;"
+                      << " convert with --wide instead. Exiting.\n";
+        }
+        else
+        {
+            std::cerr << writer.unencodable << " addresses do not fit the binary encoding, convert with --wide or --delta. Exiting.\n";
+        }
+        status = 1;
+    }
+    if (std::fseek(writer.file, 0, SEEK_SET) != 0 || !writeHeader(writer))
+    {
+        std::cerr << "Could not finalize binary trace header. Exiting.\n";
+        status = 1;
+    }
+    if (std::fclose(writer.file) != 0)
+    {
+        std::cerr << "Could not write binary trace. Exiting.\n";
+        status = 1;
+    }
+    writer.file = nullptr;
+    return status;
+}
+
+int convertTrace(const char *inputPath, const char *outputPath, uint32_t flags)
+{
+    TraceReader reader;
+    if (traceOpen(reader, inputPath) == 1)
+    {
+        return 1;
+    }
+
+    TraceWriter writer;
+    if (traceWriterOpen(writer, outputPath, flags) == 1)
+    {
+        traceClose(reader);
+        std::remove(outputPath); // a header that could not be written leaves an empty file
+        return 1;
+    }
+
+    TraceRecord record;
+    while (traceNext(reader, record))
+    {
+        traceWrite(writer, record);
+    }
+    traceClose(reader);
+
+    if (traceWriterClose(writer) == 1)
+    {
+        std::remove(outputPath); // no partial trace is left behind
+        return 1;
+    }
+    return 0;
+}
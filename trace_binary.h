@@ -0,0 +1,210 @@
+#ifndef TRACEBINARY_H
+#define TRACEBINARY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "trace_reader.h"
+
+// BINARY TRACE FORMAT
+//
+// A binary trace is a BinaryTraceHeader followed by recordCount records,
+// all little-endian. Two record encodings exist:
+//
+// - fixed (no TRACE_FLAG_DELTA): 8 bytes per record, a uint32_t address followed by a
+//   uint32_t holding the store bit in bit 0 and the access size in bits 1-31.
+//   With TRACE_FLAG_WIDE the address is a uint64_t (12 bytes per record).
+// - delta (TRACE_FLAG_DELTA): two LEB128 varints per record. The first is the
+//   zigzag-encoded difference from the previous address shifted left by one,
+//   with the store bit in bit 0; the second is the access size. Most records
+//   of a real trace fit in 2-4 bytes, and a varint longer than its value can
+//   need (10 bytes, 5 for 32-bit values) marks the trace corrupt. Differences are taken modulo 2^64, so
+//   64-bit addresses need no flag as long as consecutive addresses are less
+//   than 2^62 apart (always true of canonical 48- and 57-bit addresses).
+//
+// With TRACE_FLAG_CORE, every record is followed by its core id: a uint32_t
+// in the fixed encoding, a varint in the delta encoding.
+
+static const char TRACE_MAGIC[8] = {'C', 'S', 'I', 'M', 'T', 'R', 'C', '\0'};
+static const uint32_t TRACE_VERSION = 1;
+static const uint32_t TRACE_FLAG_DELTA = 1u << 0;
+static const uint32_t TRACE_FLAG_CORE = 1u << 1;
+static const uint32_t TRACE_FLAG_WIDE = 1u << 2;
+
+// longest encoding of a single record, used to size read-ahead
+static const size_t TRACE_MAX_RECORD_BYTES = 20;
+
+/**
+ * Struct representing the fixed header at the start of a binary trace.
+ */
+struct BinaryTraceHeader
+{
+    char magic[8];        // TRACE_MAGIC
+    uint32_t version;     // TRACE_VERSION
+    uint32_t flags;       // Record encoding (TRACE_FLAG_*)
+    uint64_t recordCount; // Number of records following the header
+};
+
+/**
+ * Struct representing a binary trace being written.
+ * Records are buffered and the header is rewritten with the final count on close.
+ */
+struct TraceWriter
+{
+    std::FILE *file = nullptr; // The output file
+    uint32_t flags = 0;        // Record encoding being written
+    uint64_t recordCount = 0;  // Number of records written so far
+    uint64_t prevAddress = 0;  // Last address written (used for delta encoding)
+    uint64_t unencodable = 0;  // Records whose address the chosen encoding cannot hold
+};
+
+/**
+ * Checks whether a byte range starts with a binary trace header.
+ *
+ * @param data Pointer to the first bytes of the input.
+ * @param size Number of bytes available at data.
+ * @return true if the bytes carry the binary trace magic, false otherwise.
+ */
+inline bool isBinaryTrace(const char *data, size_t size)
+{
+    return size >= sizeof(BinaryTraceHeader) && std::memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0;
+}
+
+// longest varints a record may hold: 64-bit and 32-bit values, 7 bits per byte
+static const int TRACE_MAX_VARINT64_BYTES = 10;
+static const int TRACE_MAX_VARINT32_BYTES = 5;
+
+/**
+ * Decodes one LEB128 varint of at most maxBytes bytes and advances the cursor past it.
+ *
+ * @param p Reference to the cursor.
+ * @param maxBytes The longest encoding the value may have.
+ * @param value Reference to the decoded value.
+ * @return true for success, false if the varint is longer than maxBytes (corrupt input).
+ */
+inline bool decodeVarint(const char *&p, int maxBytes, uint64_t &value)
+{
+    value = 0;
+    for (int i = 0; i < maxBytes; i++)
+    {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Decodes one binary record and advances the cursor past it.
+ * The caller guarantees at least TRACE_MAX_RECORD_BYTES are readable, or that
+ * the remaining bytes hold a whole record.
+ *
+ * @param p Reference to the cursor into the record stream.
+ * @param flags Record encoding from the header.
+ * @param prevAddress Reference to the previous address (updated for delta encoding).
+ * @param record Reference to the TraceRecord to fill in.
+ * @return true for success, false if a varint is too long to be valid (corrupt input).
+ */
+inline bool decodeBinaryRecord(const char *&p, uint32_t flags, uint64_t &prevAddress, TraceRecord &record)
+{
+    if (flags & TRACE_FLAG_DELTA)
+    {
+        uint64_t value;
+        if (!decodeVarint(p, TRACE_MAX_VARINT64_BYTES, value))
+        {
+            return false;
+        }
+        uint64_t zigzag = value >> 1;
+        int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        prevAddress += static_cast<uint64_t>(delta);
+        record.loadStore = (value & 1) ? 's' : 'l';
+        record.address = prevAddress;
+
+        uint64_t size;
+        if (!decodeVarint(p, TRACE_MAX_VARINT32_BYTES, size))
+        {
+            return false;
+        }
+        record.size = static_cast<uint32_t>(size);
+
+        uint64_t core = 0;
+        if ((flags & TRACE_FLAG_CORE) && !decodeVarint(p, TRACE_MAX_VARINT32_BYTES, core))
+        {
+            return false;
+        }
+        record.core = static_cast<uint32_t>(core);
+    }
+    else
+    {
+        if (flags & TRACE_FLAG_WIDE)
+        {
+            std::memcpy(&record.address, p, sizeof(uint64_t));
+            p += sizeof(uint64_t);
+        }
+        else
+        {
+            uint32_t address;
+            std::memcpy(&address, p, sizeof(address));
+            p += sizeof(address);
+            record.address = address;
+        }
+        uint32_t field;
+        std::memcpy(&field, p, sizeof(field));
+        p += sizeof(field);
+        record.loadStore = (field & 1) ? 's' : 'l';
+        record.size = field >> 1;
+
+        uint32_t core = 0;
+        if (flags & TRACE_FLAG_CORE)
+        {
+            std::memcpy(&core, p, sizeof(core));
+            p += sizeof(core);
+        }
+        record.core = core;
+    }
+    return true;
+}
+
+/**
+ * Creates a binary trace file and writes a provisional header.
+ *
+ * @param writer Reference to the TraceWriter to initialize.
+ * @param path Path of the binary trace to create.
+ * @param flags Record encoding to use (TRACE_FLAG_* bits).
+ * @return int 0 for success, 1 if the file could not be created.
+ */
+int traceWriterOpen(TraceWriter &writer, const char *path, uint32_t flags);
+
+/**
+ * Appends one record to a binary trace.
+ *
+ * @param writer Reference to an open TraceWriter.
+ * @param record The record to encode.
+ */
+void traceWrite(TraceWriter &writer, const TraceRecord &record);
+
+/**
+ * Writes the final header and closes a binary trace.
+ * Fails if any address did not fit the encoding.
+ *
+ * @param writer Reference to the TraceWriter to close.
+ * @return int 0 for success, 1 if the output could not be completed.
+ */
+int traceWriterClose(TraceWriter &writer);
+
+/**
+ * Converts a text trace into the binary trace format, deleting the output if
+ * the conversion fails.
+ *
+ * @param inputPath Path of the text trace, or nullptr / "-" for standard input.
+ * @param outputPath Path of the binary trace to create.
+ * @param flags Record encoding to use (TRACE_FLAG_* bits).
+ * @return int 0 for success, 1 for failure.
+ */
+int convertTrace(const char *inputPath, const char *outputPath, uint32_t flags);
+
+#endif // TRACEBINARY_H
@@ -0,0 +1,341 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "trace_decompress.h"
+
+// zlib window bits that accept a gzip wrapper only
+static const int GZIP_WINDOW_BITS = 15 + 16;
+// most compressed bytes handed to zlib at once (its counts are 32-bit)
+static const size_t DECOMPRESS_MAX_INPUT = 1 << 30;
+
+bool isGzipTrace(const char *data, size_t size)
+{
+    return size >= 2 && static_cast<uint8_t>(data[0]) == 0x1f && static_cast<uint8_t>(data[1]) == 0x8b;
+}
+
+static uint32_t readLittle(const uint8_t *p, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// the size of the BGZF member at the start of p, or 0 if it does not record one
+static size_t bgzfMemberSize(const uint8_t *p, size_t remaining)
+{
+    if (remaining < 18 || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8 || !(p[3] & 4))
+    {
+        return 0;
+    }
+    size_t extraEnd = 12 + readLittle(p + 10, 2);
+    for (size_t field = 12; field + 4 <= extraEnd && extraEnd <= remaining; field += 4 + readLittle(p + field + 2, 2))
+    {
+        if (p[field] == 'B' && p[field + 1] == 'C' && readLittle(p + field + 2, 2) == 2 && field + 6 <= extraEnd)
+        {
+            size_t size = readLittle(p + field + 4, 2) + 1;
+            return size >= extraEnd + 8 && size <= remaining ? size : 0;
+        }
+    }
+    return 0;
+}
+
+// splits a BGZF input into units of consecutive members, or returns false if any member
+// does not record its size
+static bool splitMembers(TraceDecompressor &decompressor)
+{
+    size_t position = 0;
+    size_t unitBytes = 0;
+    decompressor.unitStart.assign(1, 0);
+    while (position < decompressor.inputSize)
+    {
+        size_t size = bgzfMemberSize(decompressor.input + position, decompressor.inputSize - position);
+        if (size == 0)
+        {
+            return false;
+        }
+        unitBytes += readLittle(decompressor.input + position + size - 4, 4); // ISIZE
+        position += size;
+        if (position - decompressor.unitStart.back() >= DECOMPRESS_UNIT_BYTES || position == decompressor.inputSize)
+        {
+            decompressor.unitStart.push_back(position);
+            decompressor.unitBytes.push_back(unitBytes);
+            unitBytes = 0;
+        }
+    }
+    return true;
+}
+
+// inflates the members of one unit into output, sized to their ISIZE fields
+static bool inflateUnit(z_stream &stream, const uint8_t *input, size_t size, std::vector<char> &output)
+{
+    char empty;
+    inflateReset(&stream);
+    stream.next_in = const_cast<Bytef *>(input);
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef *>(output.empty() ? &empty : output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+    while (stream.avail_in > 0)
+    {
+        int status = inflate(&stream, Z_NO_FLUSH);
+        if (status == Z_STREAM_END)
+        {
+            inflateReset(&stream); // the next member
+        }
+        else if (status != Z_OK)
+        {
+            return false;
+        }
+    }
+    return stream.avail_out == 0;
+}
+
+// hands a decoded slot to the reader
+static void publish(TraceDecompressor &decompressor, DecodedChunk &slot, size_t unit, bool corrupt, bool last)
+{
+    {
+        std::lock_guard<std::mutex> guard(decompressor.lock);
+        slot.unit = unit;
+        slot.corrupt = corrupt;
+        slot.ready = true;
+        if (last)
+        {
+            decompressor.totalUnits = unit + 1;
+        }
+    }
+    decompressor.produced.notify_all();
+}
+
+// BGZF worker: takes the next unit whose ring slot the reader has released
+static void unitWorker(TraceDecompressor &decompressor)
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    inflateInit2(&stream, GZIP_WINDOW_BITS);
+    size_t slots = decompressor.slots.size();
+    while (true)
+    {
+        size_t unit;
+        {
+            std::unique_lock<std::mutex> guard(decompressor.lock);
+            decompressor.consumed.wait(guard, [&]()
+                                       { return decompressor.stopping || decompressor.nextUnit >= decompressor.totalUnits ||
+                                                decompressor.nextUnit < decompressor.consumedUnits + slots; });
+            if (decompressor.stopping || decompressor.nextUnit >= decompressor.totalUnits)
+            {
+                break;
+            }
+            unit = decompressor.nextUnit++;
+        }
+        DecodedChunk &slot = decompressor.slots[unit % slots];
+        slot.bytes.resize(decompressor.unitBytes[unit]);
+        size_t start = decompressor.unitStart[unit];
+        bool good = inflateUnit(stream, decompressor.input + start, decompressor.unitStart[unit + 1] - start, slot.bytes);
+        publish(decompressor, slot, unit, !good, false);
+    }
+    inflateEnd(&stream);
+}
+
+// refills the input of a sequential inflate; false once the input is exhausted
+static bool nextInput(TraceDecompressor &decompressor, z_stream &stream, size_t &position, std::vector<uint8_t> &buffer)
+{
+    if (decompressor.fd < 0)
+    {
+        size_t piece = std::min(decompressor.inputSize - position, DECOMPRESS_MAX_INPUT);
+        stream.next_in = const_cast<Bytef *>(decompressor.input + position);
+        stream.avail_in = static_cast<uInt>(piece);
+        position += piece;
+        return piece > 0;
+    }
+    if (!decompressor.pending.empty())
+    {
+        buffer.swap(decompressor.pending);
+        decompressor.pending.clear();
+    }
+    else
+    {
+        buffer.resize(DECOMPRESS_CHUNK_BYTES);
+        ssize_t n = read(decompressor.fd, buffer.data(), buffer.size());
+        buffer.resize(n > 0 ? n : 0);
+    }
+    stream.next_in = buffer.data();
+    stream.avail_in = static_cast<uInt>(buffer.size());
+    return !buffer.empty();
+}
+
+// single worker for gzip inputs that cannot be split: inflates the whole input, a chunk per unit
+static void streamWorker(TraceDecompressor &decompressor)
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    inflateInit2(&stream, GZIP_WINDOW_BITS);
+    std::vector<uint8_t> buffer;
+    size_t position = 0;
+    size_t slots = decompressor.slots.size();
+    bool inMember = false;
+    bool done = false;
+    for (size_t unit = 0; !done; unit++)
+    {
+        {
+            std::unique_lock<std::mutex> guard(decompressor.lock);
+            decompressor.consumed.wait(guard, [&]()
+                                       { return decompressor.stopping || unit < decompressor.consumedUnits + slots; });
+            if (decompressor.stopping)
+            {
+                break;
+            }
+        }
+        DecodedChunk &slot = decompressor.slots[unit % slots];
+        slot.bytes.resize(DECOMPRESS_CHUNK_BYTES);
+        size_t filled = 0;
+        bool corrupt = false;
+        while (filled < DECOMPRESS_CHUNK_BYTES && !done)
+        {
+            if (stream.avail_in == 0 && !nextInput(decompressor, stream, position, buffer))
+            {
+                done = true;
+                corrupt = inMember; // cut off inside a member
+                break;
+            }
+            stream.next_out = reinterpret_cast<Bytef *>(slot.bytes.data() + filled);
+            stream.avail_out = static_cast<uInt>(DECOMPRESS_CHUNK_BYTES - filled);
+            int status = inflate(&stream, Z_NO_FLUSH);
+            filled = DECOMPRESS_CHUNK_BYTES - stream.avail_out;
+            if (status == Z_STREAM_END)
+            {
+                inflateReset(&stream); // concatenated members continue the trace
+                inMember = false;
+                if (stream.avail_in > 0 && !isGzipTrace(reinterpret_cast<const char *>(stream.next_in), stream.avail_in))
+                {
+                    done = true; // trailing bytes that are not a member are ignored, as gzip does
+                }
+            }
+            else if (status == Z_OK || (status == Z_BUF_ERROR && stream.avail_in == 0))
+            {
+                inMember = true;
+            }
+            else
+            {
+                done = true;
+                corrupt = true;
+            }
+        }
+        slot.bytes.resize(filled);
+        publish(decompressor, slot, unit, corrupt, done);
+    }
+    inflateEnd(&stream);
+}
+
+static TraceDecompressor *start(TraceDecompressor *decompressor, bool split)
+{
+    unsigned threads = 1;
+    if (split)
+    {
+        unsigned cores = std::thread::hardware_concurrency();
+        threads = std::max(1u, std::min(cores > 1 ? cores - 1 : 1, DECOMPRESS_MAX_THREADS)); // one core simulates
+        decompressor->totalUnits = decompressor->unitBytes.size();
+    }
+    decompressor->slots.resize(2 * threads + 2);
+    for (unsigned t = 0; t < threads; t++)
+    {
+        decompressor->workers.emplace_back(split ? unitWorker : streamWorker, std::ref(*decompressor));
+    }
+    return decompressor;
+}
+
+TraceDecompressor *decompressorStartMapped(void *mapping, size_t size)
+{
+    TraceDecompressor *decompressor = new TraceDecompressor();
+    decompressor->mapping = mapping;
+    decompressor->mappingSize = size;
+    decompressor->input = static_cast<const uint8_t *>(mapping);
+    decompressor->inputSize = size;
+    bool split = splitMembers(*decompressor);
+    if (!split)
+    {
+        decompressor->unitStart.clear();
+        decompressor->unitBytes.clear();
+    }
+    return start(decompressor, split);
+}
+
+TraceDecompressor *decompressorStartStream(int fd, const char *head, size_t headSize)
+{
+    TraceDecompressor *decompressor = new TraceDecompressor();
+    decompressor->fd = fd;
+    decompressor->pending.assign(head, head + headSize);
+    return start(decompressor, false);
+}
+
+size_t decompressorRead(TraceDecompressor &decompressor, char *destination, size_t capacity)
+{
+    size_t copied = 0;
+    size_t slots = decompressor.slots.size();
+    while (copied < capacity)
+    {
+        DecodedChunk *slot;
+        {
+            std::unique_lock<std::mutex> guard(decompressor.lock);
+            size_t unit = decompressor.consumedUnits;
+            decompressor.produced.wait(guard, [&]()
+                                       { return unit >= decompressor.totalUnits ||
+                                                (decompressor.slots[unit % slots].ready && decompressor.slots[unit % slots].unit == unit); });
+            if (unit >= decompressor.totalUnits)
+            {
+                break;
+            }
+            slot = &decompressor.slots[unit % slots];
+        }
+
+        size_t n = std::min(capacity - copied, slot->bytes.size() - decompressor.offset);
+        std::memcpy(destination + copied, slot->bytes.data() + decompressor.offset, n);
+        decompressor.offset += n;
+        copied += n;
+        if (decompressor.offset == slot->bytes.size())
+        {
+            bool corrupt = slot->corrupt;
+            {
+                std::lock_guard<std::mutex> guard(decompressor.lock);
+                slot->ready = false;
+                decompressor.consumedUnits++;
+                decompressor.offset = 0;
+                if (corrupt)
+                {
+                    decompressor.failed = true;
+                    decompressor.totalUnits = decompressor.consumedUnits; // the trace ends at the damage
+                }
+            }
+            decompressor.consumed.notify_all();
+            if (corrupt)
+            {
+                std::cerr << "Compressed trace is corrupt or truncated, simulating the records before the damage only.\n";
+            }
+        }
+    }
+    return copied;
+}
+
+void decompressorClose(TraceDecompressor *decompressor)
+{
+    {
+        std::lock_guard<std::mutex> guard(decompressor->lock);
+        decompressor->stopping = true;
+    }
+    decompressor->consumed.notify_all();
+    for (std::thread &worker : decompressor->workers)
+    {
+        worker.join();
+    }
+    if (decompressor->mapping)
+    {
+        munmap(decompressor->mapping, decompressor->mappingSize);
+    }
+    delete decompressor;
+}
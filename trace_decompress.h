@@ -0,0 +1,127 @@
+#ifndef TRACE_DECOMPRESS_H
+#define TRACE_DECOMPRESS_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// COMPRESSED TRACES
+//
+// A gzip-compressed trace, text or binary, is decompressed on background
+// threads into a bounded ring of decoded chunks, which the reader copies
+// into its buffer and parses on the simulating thread as it would a pipe.
+// BGZF files (bgzip, and any gzip file made of members that record their
+// compressed size in a "BC" extra field) are split at member boundaries
+// without decompressing anything: runs of members are inflated in parallel,
+// each into the ring slot of its place in the trace, and handed to the
+// reader in order. Other gzip files, concatenated members included, cannot
+// be split before they are decompressed, so one background thread inflates
+// them, overlapping decompression with the simulation.
+
+// compressed bytes of consecutive BGZF members decompressed as one unit
+static const size_t DECOMPRESS_UNIT_BYTES = 256 << 10;
+// decoded bytes of a unit of a sequentially decompressed trace
+static const size_t DECOMPRESS_CHUNK_BYTES = 1 << 20;
+// most background threads used for a BGZF trace
+static const unsigned DECOMPRESS_MAX_THREADS = 8;
+
+/**
+ * Struct representing one slot of the decoded chunk ring.
+ */
+struct DecodedChunk
+{
+    std::vector<char> bytes; // Decoded bytes of the unit held
+    size_t unit = 0;         // Position of the unit in the trace
+    bool ready = false;      // The bytes are decoded and not yet consumed
+    bool corrupt = false;    // Decoding failed after the bytes held; the trace ends with them
+};
+
+/**
+ * Struct representing the background decompression of one trace.
+ */
+struct TraceDecompressor
+{
+    // INPUT: the mapped file, or a descriptor streamed by the single worker
+    const uint8_t *input = nullptr;
+    size_t inputSize = 0;
+    void *mapping = nullptr; // Mapping released on close, or null
+    size_t mappingSize = 0;
+    int fd = -1;
+    std::vector<uint8_t> pending; // Streamed bytes read before the input was recognized as gzip
+
+    // UNITS (BGZF): compressed offset of each unit and one past the last, and decoded size of each unit
+    std::vector<size_t> unitStart;
+    std::vector<size_t> unitBytes;
+
+    // RING, guarded by lock
+    std::vector<DecodedChunk> slots;
+    std::mutex lock;
+    std::condition_variable produced;
+    std::condition_variable consumed;
+    size_t nextUnit = 0;             // Next unit a worker takes (BGZF)
+    size_t consumedUnits = 0;        // Units the reader has finished with
+    size_t totalUnits = SIZE_MAX;    // Units in the trace, once known
+    bool failed = false;             // The input is corrupt; the trace ends at the last good unit
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    // READER POSITION in the slot of unit consumedUnits
+    size_t offset = 0;
+};
+
+/**
+ * Checks for the gzip magic number.
+ *
+ * @param data The first bytes of the input.
+ * @param size The number of bytes available.
+ *
+ * @return true if the input is gzip-compressed.
+ */
+bool isGzipTrace(const char *data, size_t size);
+
+/**
+ * Starts decompressing a mapped gzip trace, which the decompressor then owns
+ * and unmaps on close.
+ *
+ * @param mapping The mapped file.
+ * @param size The size of the file.
+ *
+ * @return TraceDecompressor* The started decompressor.
+ */
+TraceDecompressor *decompressorStartMapped(void *mapping, size_t size);
+
+/**
+ * Starts decompressing a gzip trace streamed from a descriptor, whose first
+ * bytes were already read.
+ *
+ * @param fd The descriptor to read the rest of the trace from.
+ * @param head The bytes already read.
+ * @param headSize The number of bytes already read.
+ *
+ * @return TraceDecompressor* The started decompressor.
+ */
+TraceDecompressor *decompressorStartStream(int fd, const char *head, size_t headSize);
+
+/**
+ * Copies decoded bytes out of the ring, waiting for the background threads
+ * when none are ready.
+ *
+ * @param decompressor Reference to the started TraceDecompressor.
+ * @param destination Where to copy the bytes.
+ * @param capacity The most bytes to copy.
+ *
+ * @return size_t The number of bytes copied, 0 at the end of the trace.
+ */
+size_t decompressorRead(TraceDecompressor &decompressor, char *destination, size_t capacity);
+
+/**
+ * Stops the background threads, releases the input and deletes the decompressor.
+ *
+ * @param decompressor The started TraceDecompressor.
+ */
+void decompressorClose(TraceDecompressor *decompressor);
+
+#endif // TRACE_DECOMPRESS_H
@@ -0,0 +1,319 @@
+#include <iostream>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace_reader.h"
+#include "trace_binary.h"
+#include "trace_decompress.h"
+
+// size of each read() in the streaming fallback
+static const size_t TRACE_CHUNK_SIZE = 1 << 20;
+// refill before fewer than this many bytes remain, so a whole line is always buffered
+static const size_t TRACE_LOW_WATER = 4096;
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    c |= 0x20; // fold to lower case
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// moves the unparsed tail to the front of the buffer and reads more bytes behind it
+static void traceRefill(TraceReader &reader)
+{
+    size_t remaining = reader.size - reader.pos;
+    std::memmove(reader.buffer.data(), reader.buffer.data() + reader.pos, remaining);
+    reader.pos = 0;
+    reader.size = remaining;
+
+    while (reader.size < reader.buffer.size())
+    {
+        ssize_t n = reader.decompressor
+                        ? decompressorRead(*reader.decompressor, reader.buffer.data() + reader.size, reader.buffer.size() - reader.size)
+                        : read(reader.fd, reader.buffer.data() + reader.size, reader.buffer.size() - reader.size);
+        if (n <= 0)
+        {
+            reader.eof = true;
+            break;
+        }
+        reader.size += n;
+    }
+    reader.data = reader.buffer.data();
+}
+
+// consumes the binary header if the input starts with one
+static int detectFormat(TraceReader &reader)
+{
+    if (!isBinaryTrace(reader.data, reader.size))
+    {
+        return 0;
+    }
+
+    BinaryTraceHeader header;
+    std::memcpy(&header, reader.data, sizeof(header));
+    if (header.version != TRACE_VERSION || (header.flags & ~(TRACE_FLAG_DELTA | TRACE_FLAG_CORE | TRACE_FLAG_WIDE)) != 0)
+    {
+        std::cerr << "Unsupported binary trace version. Exiting.\n";
+        return 1;
+    }
+    reader.binary = true;
+    reader.flags = header.flags;
+    reader.prevAddress = 0;
+    reader.pos = sizeof(header);
+    return 0;
+}
+
+// ends a binary trace at a record that cannot be valid
+static bool binaryCorrupt(TraceReader &reader)
+{
+    std::cerr << "Binary trace is corrupt, simulating the records before the damage only.\n";
+    reader.pos = reader.size;
+    return false;
+}
+
+// decodes one binary record, refusing records cut short by the end of the input
+static bool binaryNext(TraceReader &reader, TraceRecord &record)
+{
+    size_t remaining = reader.size - reader.pos;
+    if (remaining == 0)
+    {
+        return false;
+    }
+
+    const char *p = reader.data + reader.pos;
+    if (remaining >= TRACE_MAX_RECORD_BYTES)
+    {
+        if (!decodeBinaryRecord(p, reader.flags, reader.prevAddress, record))
+        {
+            return binaryCorrupt(reader);
+        }
+        reader.pos = p - reader.data;
+        return true;
+    }
+
+    // tail of the input: decode from a zero-padded copy so a truncated record cannot overrun
+    char tail[TRACE_MAX_RECORD_BYTES] = {};
+    std::memcpy(tail, p, remaining);
+    const char *q = tail;
+    if (!decodeBinaryRecord(q, reader.flags, reader.prevAddress, record))
+    {
+        return binaryCorrupt(reader);
+    }
+    size_t used = q - tail;
+    if (used > remaining)
+    {
+        reader.pos = reader.size;
+        return false;
+    }
+    reader.pos += used;
+    return true;
+}
+
+// starts parsing the buffer that the decompressor fills
+static int startBuffered(TraceReader &reader)
+{
+    reader.buffer.resize(TRACE_CHUNK_SIZE);
+    reader.eof = false;
+    reader.pos = 0;
+    reader.size = 0;
+    traceRefill(reader);
+    return detectFormat(reader);
+}
+
+int traceOpen(TraceReader &reader, const char *path)
+{
+    if (path == nullptr || std::strcmp(path, "-") == 0)
+    {
+        reader.fd = STDIN_FILENO;
+        reader.ownsFd = false;
+    }
+    else
+    {
+        reader.fd = open(path, O_RDONLY);
+        if (reader.fd < 0)
+        {
+            std::cerr << "Could not open trace file " << path << ". Exiting.\n";
+            return 1;
+        }
+        reader.ownsFd = true;
+    }
+
+    // map regular files (including a file redirected to stdin) directly
+    struct stat info;
+    if (fstat(reader.fd, &info) == 0 && S_ISREG(info.st_mode))
+    {
+        if (info.st_size == 0)
+        {
+            reader.eof = true;
+            return 0;
+        }
+        void *region = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, reader.fd, 0);
+        if (region != MAP_FAILED)
+        {
+            madvise(region, info.st_size, MADV_SEQUENTIAL);
+            if (isGzipTrace(static_cast<const char *>(region), info.st_size))
+            {
+                reader.decompressor = decompressorStartMapped(region, info.st_size);
+                return startBuffered(reader);
+            }
+            reader.mapped = true;
+            reader.eof = true;
+            reader.data = static_cast<const char *>(region);
+            reader.size = info.st_size;
+            return detectFormat(reader);
+        }
+    }
+
+    // pipes, terminals or unmappable files: stream through a buffer
+    reader.buffer.resize(TRACE_CHUNK_SIZE);
+    reader.data = reader.buffer.data();
+    traceRefill(reader);
+    if (isGzipTrace(reader.data, reader.size))
+    {
+        reader.decompressor = decompressorStartStream(reader.fd, reader.data, reader.size);
+        return startBuffered(reader);
+    }
+    return detectFormat(reader);
+}
+
+bool traceNext(TraceReader &reader, TraceRecord &record)
+{
+    if (!reader.eof && reader.size - reader.pos < TRACE_LOW_WATER)
+    {
+        traceRefill(reader);
+    }
+    if (reader.binary)
+    {
+        return binaryNext(reader, record);
+    }
+
+    const char *p = reader.data + reader.pos;
+    const char *end = reader.data + reader.size;
+
+    // field 1: l or s
+    while (p < end && isSpace(*p))
+    {
+        p++;
+    }
+    if (p == end)
+    {
+        reader.pos = reader.size;
+        return false;
+    }
+    record.loadStore = *p++;
+
+    // field 2: hexadecimal address of up to 64 bits, with or without a 0x prefix
+    while (p < end && isSpace(*p))
+    {
+        p++;
+    }
+    if (end - p >= 2 && p[0] == '0' && (p[1] | 0x20) == 'x')
+    {
+        p += 2;
+    }
+    uint64_t address = 0;
+    int digit;
+    while (p < end && (digit = hexValue(*p)) >= 0)
+    {
+        address = (address << 4) | digit;
+        p++;
+    }
+    record.address = address;
+
+    // field 3: decimal length, anything else in the token is ignored
+    while (p < end && isSpace(*p))
+    {
+        p++;
+    }
+    if (p == end)
+    {
+        // truncated final line, same as the stream extraction failing
+        reader.pos = reader.size;
+        return false;
+    }
+    uint32_t size = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        size = size * 10 + (*p - '0');
+        p++;
+    }
+    while (p < end && !isSpace(*p))
+    {
+        p++;
+    }
+    record.size = size;
+
+    // optional field 4 on the same line: decimal core id
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    uint32_t core = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        core = core * 10 + (*p - '0');
+        p++;
+    }
+    record.core = core;
+
+    reader.pos = p - reader.data;
+    return true;
+}
+
+size_t traceNextBatch(TraceReader &reader, TraceBatch &batch)
+{
+    size_t capacity = batch.addresses.size();
+    TraceRecord record;
+    batch.count = 0;
+    while (batch.count < capacity && traceNext(reader, record))
+    {
+        batch.loadStore[batch.count] = record.loadStore;
+        batch.addresses[batch.count] = record.address;
+        batch.count++;
+    }
+    return batch.count;
+}
+
+void traceClose(TraceReader &reader)
+{
+    if (reader.mapped)
+    {
+        munmap(const_cast<char *>(reader.data), reader.size);
+    }
+    if (reader.decompressor)
+    {
+        decompressorClose(reader.decompressor); // before the descriptor it may be reading
+        reader.decompressor = nullptr;
+    }
+    if (reader.ownsFd && reader.fd >= 0)
+    {
+        close(reader.fd);
+    }
+    reader.fd = -1;
+    reader.ownsFd = false;
+    reader.mapped = false;
+    reader.eof = true;
+    reader.data = nullptr;
+    reader.size = 0;
+    reader.pos = 0;
+    reader.binary = false;
+    reader.flags = 0;
+    reader.prevAddress = 0;
+    std::vector<char>().swap(reader.buffer);
+}
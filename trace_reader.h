@@ -0,0 +1,102 @@
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// default number of records decoded into a TraceBatch at a time
+static const size_t TRACE_BATCH_SIZE = 4096;
+
+// STRUCTS TO REPRESENT THE TRACE INPUT
+
+struct TraceDecompressor;
+
+/**
+ * Struct representing a single decoded trace record.
+ * Mirrors one line of the text trace format described in the README.
+ */
+struct TraceRecord
+{
+    char loadStore;   // 'l' for load, 's' for store
+    uint64_t address; // The memory address being accessed
+    uint32_t size;    // Access length (unused in the cache simulation)
+    uint32_t core;    // Issuing core or thread (optional fourth field, 0 if absent)
+};
+
+/**
+ * Struct representing a run of decoded records as parallel arrays, the layout
+ * cacheSimulateBatch consumes. Its capacity is the size of the arrays.
+ */
+struct TraceBatch
+{
+    std::vector<char> loadStore;     // 'l' or 's' of each record
+    std::vector<uint64_t> addresses; // Address of each record
+    size_t count = 0;                // Number of valid records
+
+    explicit TraceBatch(size_t capacity = TRACE_BATCH_SIZE) : loadStore(capacity), addresses(capacity) {}
+};
+
+/**
+ * Struct representing an open trace input.
+ * Regular files are memory-mapped and parsed in place; pipes and terminals
+ * fall back to reading fixed-size chunks into a reusable buffer. Both text
+ * traces and binary traces (see trace_binary.h) are detected automatically,
+ * and so are gzip-compressed ones, which are decompressed in the background
+ * into the buffer.
+ */
+struct TraceReader
+{
+    int fd = -1;                // The file descriptor being read
+    bool ownsFd = false;        // Indicates if traceClose should close the descriptor
+    bool mapped = false;        // Indicates if data points at an mmap'd region
+    bool eof = false;           // Indicates if the descriptor has no more bytes to read
+    const char *data = nullptr; // Start of the bytes currently available for parsing
+    size_t size = 0;            // Number of bytes available starting at data
+    size_t pos = 0;             // Parse position within data
+    std::vector<char> buffer;   // Backing storage for the streaming fallback
+    bool binary = false;        // Indicates if the input is a binary trace
+    uint32_t flags = 0;         // Binary record encoding (TRACE_FLAG_*)
+    uint64_t prevAddress = 0;   // Last decoded address (used for delta-encoded binary traces)
+    TraceDecompressor *decompressor = nullptr; // Background decoder of a gzip trace filling the buffer (see trace_decompress.h), or null
+};
+
+/**
+ * Opens a trace for reading.
+ *
+ * @param reader Reference to the TraceReader to initialize.
+ * @param path Path of the trace file, or nullptr / "-" to read from standard input.
+ *
+ * @return int 0 for success, 1 if the trace could not be opened.
+ */
+int traceOpen(TraceReader &reader, const char *path);
+
+/**
+ * Decodes the next record of a text or binary trace without allocating.
+ *
+ * @param reader Reference to an open TraceReader.
+ * @param record Reference to the TraceRecord to fill in.
+ *
+ * @return true if a record was decoded, false at the end of the trace.
+ */
+bool traceNext(TraceReader &reader, TraceRecord &record);
+
+/**
+ * Decodes up to a batch's capacity of records into the batch.
+ *
+ * @param reader Reference to an open TraceReader.
+ * @param batch Reference to the TraceBatch to fill in.
+ *
+ * @return size_t The number of records decoded (batch.count); less than the
+ * capacity only at the end of the trace.
+ */
+size_t traceNextBatch(TraceReader &reader, TraceBatch &batch);
+
+/**
+ * Releases the mapping, buffer and descriptor held by a reader.
+ *
+ * @param reader Reference to the TraceReader to close.
+ */
+void traceClose(TraceReader &reader);
+
+#endif // TRACEREADER_H
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "victim_cache.h"
+#include "timing.h"
+
+int parseVictimCache(const std::string &spec, VictimCache &victimCache)
+{
+    char *end;
+    long entries = std::strtol(spec.c_str(), &end, 10);
+    long latency = 1;
+    if (*end == ':')
+    {
+        const char *start = end + 1;
+        latency = std::strtol(start, &end, 10);
+        if (end == start)
+        {
+            latency = -1;
+        }
+    }
+    if (spec.empty() || *end != '\0' || entries < 1 || entries > VICTIM_CACHE_MAX_ENTRIES || latency < 0 || latency > 1000000)
+    {
+        std::cerr << "Invalid victim cache " << spec << ", expected <entries>[:<latency>] with 1 to "
+                  << VICTIM_CACHE_MAX_ENTRIES << " entries. Exiting.\n";
+        return 1;
+    }
+    victimCache.entries = static_cast<int>(entries);
+    victimCache.latency = static_cast<int>(latency);
+    return 0;
+}
+
+void victimCacheAttach(VictimCache &victimCache, Cache &cache)
+{
+    victimCache.blocks.assign(victimCache.entries, 0);
+    victimCache.dirty.assign(victimCache.entries, 0);
+    victimCache.stamps.assign(victimCache.entries, 0);
+    victimCache.clock = 0;
+    victimCacheClearStatistics(victimCache);
+    cache.victimCache = &victimCache;
+}
+
+bool victimCacheHolds(const VictimCache &victimCache, uint64_t address)
+{
+    for (int entry = 0; entry < victimCache.entries; entry++)
+    {
+        if (victimCache.blocks[entry] == address + 1)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool victimCacheTake(VictimCache &victimCache, Cache &cache, uint64_t address, bool &dirty)
+{
+    for (int entry = 0; entry < victimCache.entries; entry++)
+    {
+        if (victimCache.blocks[entry] == address + 1)
+        {
+            victimCache.blocks[entry] = 0;
+            dirty = victimCache.dirty[entry];
+            victimCache.hits++;
+            cache.totalCycles += victimCache.latency;
+            return true;
+        }
+    }
+    victimCache.misses++;
+    return false;
+}
+
+bool victimCacheStore(VictimCache &victimCache, Cache &cache, uint64_t address)
+{
+    for (int entry = 0; entry < victimCache.entries; entry++)
+    {
+        if (victimCache.blocks[entry] == address + 1)
+        {
+            victimCache.storeUpdates++;
+            if (!victimCache.dirty[entry])
+            {
+                return false; // the copy stays clean, as the store also goes to memory
+            }
+            cache.totalCycles += victimCache.latency;
+            return true;
+        }
+    }
+    return false;
+}
+
+void victimCacheInsert(VictimCache &victimCache, Cache &cache, uint64_t address, bool dirty)
+{
+    // an empty entry, or the oldest
+    int entry = 0;
+    for (int e = 0; e < victimCache.entries; e++)
+    {
+        if (victimCache.blocks[e] == 0)
+        {
+            entry = e;
+            break;
+        }
+        if (victimCache.stamps[e] < victimCache.stamps[entry])
+        {
+            entry = e;
+        }
+    }
+    if (victimCache.blocks[entry] != 0 && victimCache.dirty[entry])
+    {
+        victimCache.writeBacks++;
+        cache.writeBacks++;
+        chargeWrite(cache, memoryCycles(cache.timing, cache.numBytes), victimCache.blocks[entry] - 1); // store to memory
+    }
+    if (victimCache.clock == UINT32_MAX)
+    {
+        // entries are replaced oldest first, so every stamp is among the last entries
+        // given out: shifting them down keeps their order across a wrap of the clock
+        for (uint32_t &stamp : victimCache.stamps)
+        {
+            stamp = stamp > UINT32_MAX - VICTIM_CACHE_MAX_ENTRIES ? stamp - (UINT32_MAX - VICTIM_CACHE_MAX_ENTRIES) : 0;
+        }
+        victimCache.clock = VICTIM_CACHE_MAX_ENTRIES;
+    }
+    victimCache.blocks[entry] = address + 1;
+    victimCache.dirty[entry] = dirty;
+    victimCache.stamps[entry] = ++victimCache.clock;
+}
+
+void victimCacheClearStatistics(VictimCache &victimCache)
+{
+    victimCache.hits = 0;
+    victimCache.misses = 0;
+    victimCache.writeBacks = 0;
+    victimCache.storeUpdates = 0;
+}
+
+void displayVictimCacheStatistics(const VictimCache &victimCache)
+{
+    std::cout << "Victim cache hits: " << victimCache.hits << std::endl;
+    std::cout << "Victim cache misses: " << victimCache.misses << std::endl;
+    std::cout << "Victim cache write-backs: " << victimCache.writeBacks << std::endl;
+    std::cout << "Victim cache store updates: " << victimCache.storeUpdates << std::endl;
+}
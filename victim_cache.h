@@ -0,0 +1,130 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+
+// VICTIM CACHE
+//
+// A small fully associative buffer beside a standalone cache (Jouppi,
+// "Improving Direct-Mapped Cache Performance by the Addition of a Small
+// Fully-Associative Cache and Prefetch Buffers", ISCA 1990). Every block the
+// cache evicts moves into it, dirty or clean, instead of going to memory. A
+// miss of the cache that allocates looks the block up there first; on a hit
+// the block moves back, keeping its dirty bit, in latency cycles instead of a
+// memory fetch, and the block it displaces takes its place. The victim cache
+// replaces its least recently inserted entry, whose block is written back to
+// memory then if it is dirty. The cache's own statistics are unchanged: a
+// block found there is still a miss of the cache. A prefetcher skips blocks
+// the victim cache holds, so no block is ever in both. A store miss that does not
+// allocate updates a copy of its block in the victim cache in place: a dirty
+// copy absorbs the store, which reaches memory with that copy's write-back,
+// and a clean copy stays clean as the store writes through to memory.
+
+// most entries of a victim cache
+static const int VICTIM_CACHE_MAX_ENTRIES = 1024;
+
+/**
+ * Struct representing a victim cache and its counters.
+ */
+struct VictimCache
+{
+    // CONFIGURATION
+    int entries = 8;
+    int latency = 1; // Cycles to move a block back into the cache
+
+    // CONTENTS
+    std::vector<uint64_t> blocks; // Per entry: block address + 1, or 0 when empty
+    std::vector<uint8_t> dirty;   // Per entry: the block is modified
+    std::vector<uint32_t> stamps; // Per entry: insertion time, the oldest replaced first
+    uint32_t clock = 0;
+
+    // STATISTICS
+    uint64_t hits = 0;         // Misses of the cache served by the victim cache
+    uint64_t misses = 0;       // Misses of the cache that went to memory
+    uint64_t writeBacks = 0;   // Dirty blocks the victim cache wrote to memory
+    uint64_t storeUpdates = 0; // Stores that missed without allocating and updated a copy here
+};
+
+/**
+ * Parses a victim cache specification "entries[:latency]".
+ *
+ * @param spec The specification.
+ * @param victimCache Reference to the VictimCache to configure.
+ *
+ * @return int 0 for success, 1 for invalid input.
+ */
+int parseVictimCache(const std::string &spec, VictimCache &victimCache);
+
+/**
+ * Puts an empty victim cache beside a standalone cache.
+ *
+ * @param victimCache Reference to the configured VictimCache.
+ * @param cache Reference to the Cache.
+ */
+void victimCacheAttach(VictimCache &victimCache, Cache &cache);
+
+/**
+ * Checks whether the victim cache holds a block, without moving it or counting anything.
+ *
+ * @param victimCache Reference to the attached VictimCache.
+ * @param address Address of the block.
+ *
+ * @return true if the victim cache holds the block.
+ */
+bool victimCacheHolds(const VictimCache &victimCache, uint64_t address);
+
+/**
+ * Looks up a block the cache missed on, removing it and charging its move
+ * back if found.
+ *
+ * @param victimCache Reference to the attached VictimCache.
+ * @param cache Reference to the Cache that missed.
+ * @param address Address of the block.
+ * @param dirty Set to whether the block found is modified.
+ *
+ * @return true if the victim cache held the block.
+ */
+bool victimCacheTake(VictimCache &victimCache, Cache &cache, uint64_t address, bool &dirty);
+
+/**
+ * Updates the victim cache's copy of a block, if it has one, for a store
+ * that missed in the cache and does not allocate.
+ *
+ * @param victimCache Reference to the attached VictimCache.
+ * @param cache Reference to the Cache that missed.
+ * @param address Address of the block.
+ *
+ * @return true if a dirty copy absorbed the store, so that it is not written to memory now.
+ */
+bool victimCacheStore(VictimCache &victimCache, Cache &cache, uint64_t address);
+
+/**
+ * Moves a block the cache evicted into the victim cache, writing back the
+ * block that it replaces if that one is dirty.
+ *
+ * @param victimCache Reference to the attached VictimCache.
+ * @param cache Reference to the Cache evicting.
+ * @param address Address of the evicted block.
+ * @param dirty Indicates if the evicted block is modified.
+ */
+void victimCacheInsert(VictimCache &victimCache, Cache &cache, uint64_t address, bool dirty);
+
+/**
+ * Clears the counters; the victim cache keeps its blocks.
+ *
+ * @param victimCache Reference to the VictimCache.
+ */
+void victimCacheClearStatistics(VictimCache &victimCache);
+
+/**
+ * Prints the victim cache counters.
+ *
+ * @param victimCache Reference to the VictimCache.
+ */
+void displayVictimCacheStatistics(const VictimCache &victimCache);
+
+#endif // VICTIM_CACHE_H